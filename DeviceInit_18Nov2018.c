@@ -116,13 +116,13 @@ void DeviceInit(void)
 //	GpioDataRegs.GPACLEAR.bit.GPIO5 = 1; // uncomment if --> Set Low initially
 //	GpioDataRegs.GPASET.bit.GPIO5 = 1; // uncomment if --> Set High initially
 //---------------------------------------------------------------
-//  GPIO-06 - PIN FUNCTION = --Spare--
+//  GPIO-06 - PIN FUNCTION = jd CPU utilization pin (to be measured by oscilloscope)
 	GpioCtrlRegs.GPAMUX1.bit.GPIO6 = 0; // 0=GPIO,  1=EPWM4A,  2=SYNCI,  3=SYNCO
-	GpioCtrlRegs.GPADIR.bit.GPIO6 = 0; // 1=OUTput,  0=INput 
+	GpioCtrlRegs.GPADIR.bit.GPIO6 = 1; // 1=OUTput,  0=INput
 //	GpioDataRegs.GPACLEAR.bit.GPIO6 = 1; // uncomment if --> Set Low initially
 //	GpioDataRegs.GPASET.bit.GPIO6 = 1; // uncomment if --> Set High initially
 //---------------------------------------------------------------
-//  GPIO-07 - PIN FUNCTION = jd CPU utilization pin (to be measured by oscilloscope)
+//  GPIO-07 - PIN FUNCTION = jd screen chip select (low = selected)
 	GpioCtrlRegs.GPAMUX1.bit.GPIO7 = 0; // 0=GPIO,  1=EPWM4B,  2=SCIRX-A,  3=Resv
 	GpioCtrlRegs.GPADIR.bit.GPIO7 = 1; // 1=OUTput,  0=INput
 //	GpioDataRegs.GPACLEAR.bit.GPIO7 = 1; // uncomment if --> Set Low initially
@@ -180,8 +180,8 @@ void DeviceInit(void)
 //	GpioDataRegs.GPACLEAR.bit.GPIO28 = 1;	// uncomment if --> Set Low initially
 //	GpioDataRegs.GPASET.bit.GPIO28 = 1; // uncomment if --> Set High initially
 //---------------------------------------------------------------
-//  GPIO-29 - PIN FUNCTION = --Spare-- (can connect to SCITX on LaunchPad)
-	GpioCtrlRegs.GPAMUX2.bit.GPIO29 = 0; // 0=GPIO,  1=SCITXD-A,  2=I2C-SCL,  3=TZ3
+//  GPIO-29 - PIN FUNCTION = jd: SCITX-A, input trace dumps (trace.c), connects to SCITX on LaunchPad
+	GpioCtrlRegs.GPAMUX2.bit.GPIO29 = 1; // 0=GPIO,  1=SCITXD-A,  2=I2C-SCL,  3=TZ3
 //	GpioCtrlRegs.GPADIR.bit.GPIO29 = 0; // 1=OUTput,  0=INput 
 //	GpioDataRegs.GPACLEAR.bit.GPIO29 = 1;	// uncomment if --> Set Low initially
 //	GpioDataRegs.GPASET.bit.GPIO29 = 1; // uncomment if --> Set High initially
@@ -202,7 +202,7 @@ void DeviceInit(void)
 //	GpioDataRegs.GPBCLEAR.bit.GPIO33 = 1;	// uncomment if --> Set Low initially
 //	GpioDataRegs.GPBSET.bit.GPIO33 = 1; // uncomment if --> Set High initially
 //---------------------------------------------------------------
-//  GPIO-34 - PIN FUNCTION = switch S1.1 on LaunchPad
+//  GPIO-34 - PIN FUNCTION = switch S1.1 on LaunchPad, jd: low at start-up runs the self-test (selftest.c)
 	GpioCtrlRegs.GPBMUX1.bit.GPIO34 = 0; // 0=GPIO,  1=COMP2OUT,  2=EMU1,  3=Resv
 	GpioCtrlRegs.GPBDIR.bit.GPIO34 = 0; // 1=OUTput,  0=INput 
 //	GpioDataRegs.GPBCLEAR.bit.GPIO34 = 1; // uncomment if --> Set Low initially
@@ -0,0 +1,59 @@
+// bin_trig.c
+// Author: Joseph Dobrzanski
+// cos and sin of the angle of every encoder bin (bin * ENCODER_ANG / SF degrees)
+// in Q14 fixed point (16384 = 1.0), kept in flash.
+// Generated with round(16384 * cos(radians(bin * 1.6))) (and sin).
+
+#include "bin_trig.h"
+
+const int16 bin_cos[NUM_BINS] = {
+    16384, 16378, 16358, 16327, 16282, 16225, 16155, 16072, 15977, 15869,
+    15749, 15617, 15473, 15316, 15148, 14968, 14776, 14572, 14357, 14131,
+    13894, 13647, 13388, 13119, 12840, 12551, 12252, 11943, 11626, 11299,
+    10963, 10619, 10266, 9906, 9538, 9162, 8779, 8389, 7993, 7591,
+    7182, 6768, 6349, 5925, 5496, 5063, 4626, 4185, 3741, 3294,
+    2845, 2393, 1940, 1485, 1029, 572, 114, -343, -800, -1257,
+    -1713, -2167, -2619, -3070, -3518, -3964, -4406, -4845, -5280, -5711,
+    -6138, -6559, -6976, -7387, -7793, -8192, -8585, -8971, -9351, -9723,
+    -10087, -10444, -10792, -11132, -11463, -11786, -12099, -12403, -12697, -12981,
+    -13255, -13519, -13772, -14014, -14246, -14466, -14675, -14873, -15059, -15233,
+    -15396, -15546, -15685, -15811, -15925, -16026, -16115, -16191, -16255, -16306,
+    -16344, -16370, -16382, -16382, -16370, -16344, -16306, -16255, -16191, -16115,
+    -16026, -15925, -15811, -15685, -15546, -15396, -15233, -15059, -14873, -14675,
+    -14466, -14246, -14014, -13772, -13519, -13255, -12981, -12697, -12403, -12099,
+    -11786, -11463, -11132, -10792, -10444, -10087, -9723, -9351, -8971, -8585,
+    -8192, -7793, -7387, -6976, -6559, -6138, -5711, -5280, -4845, -4406,
+    -3964, -3518, -3070, -2619, -2167, -1713, -1257, -800, -343, 114,
+    572, 1029, 1485, 1940, 2393, 2845, 3294, 3741, 4185, 4626,
+    5063, 5496, 5925, 6349, 6768, 7182, 7591, 7993, 8389, 8779,
+    9162, 9538, 9906, 10266, 10619, 10963, 11299, 11626, 11943, 12252,
+    12551, 12840, 13119, 13388, 13647, 13894, 14131, 14357, 14572, 14776,
+    14968, 15148, 15316, 15473, 15617, 15749, 15869, 15977, 16072, 16155,
+    16225, 16282, 16327, 16358, 16378,
+};
+
+const int16 bin_sin[NUM_BINS] = {
+    0, 457, 915, 1371, 1826, 2280, 2732, 3182, 3630, 4075,
+    4516, 4954, 5388, 5818, 6243, 6664, 7079, 7489, 7893, 8291,
+    8682, 9067, 9444, 9814, 10177, 10531, 10878, 11216, 11545, 11865,
+    12176, 12477, 12769, 13050, 13322, 13583, 13833, 14073, 14302, 14520,
+    14726, 14921, 15104, 15275, 15435, 15582, 15717, 15840, 15951, 16049,
+    16135, 16208, 16269, 16317, 16352, 16374, 16384, 16380, 16364, 16336,
+    16294, 16240, 16173, 16094, 16002, 15897, 15780, 15651, 15510, 15356,
+    15191, 15014, 14825, 14624, 14412, 14189, 13955, 13710, 13454, 13187,
+    12911, 12624, 12328, 12021, 11706, 11381, 11048, 10706, 10355, 9997,
+    9630, 9256, 8875, 8487, 8093, 7692, 7285, 6872, 6454, 6031,
+    5604, 5172, 4735, 4296, 3853, 3406, 2958, 2507, 2053, 1599,
+    1143, 686, 229, -229, -686, -1143, -1599, -2053, -2507, -2958,
+    -3406, -3853, -4296, -4735, -5172, -5604, -6031, -6454, -6872, -7285,
+    -7692, -8093, -8487, -8875, -9256, -9630, -9997, -10355, -10706, -11048,
+    -11381, -11706, -12021, -12328, -12624, -12911, -13187, -13454, -13710, -13955,
+    -14189, -14412, -14624, -14825, -15014, -15191, -15356, -15510, -15651, -15780,
+    -15897, -16002, -16094, -16173, -16240, -16294, -16336, -16364, -16380, -16384,
+    -16374, -16352, -16317, -16269, -16208, -16135, -16049, -15951, -15840, -15717,
+    -15582, -15435, -15275, -15104, -14921, -14726, -14520, -14302, -14073, -13833,
+    -13583, -13322, -13050, -12769, -12477, -12176, -11865, -11545, -11216, -10878,
+    -10531, -10177, -9814, -9444, -9067, -8682, -8291, -7893, -7489, -7079,
+    -6664, -6243, -5818, -5388, -4954, -4516, -4075, -3630, -3182, -2732,
+    -2280, -1826, -1371, -915, -457,
+};
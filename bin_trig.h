@@ -0,0 +1,15 @@
+// bin_trig.h
+// Author: Joseph Dobrzanski
+// Q14 cos/sin table for the encoder bins (see bin_trig.c).
+
+#ifndef BIN_TRIG_H
+#define BIN_TRIG_H
+
+#include "main_file.h"
+
+#define TRIG_SHIFT  14  // table values are scaled by 1 << TRIG_SHIFT
+
+extern const int16 bin_cos[NUM_BINS];
+extern const int16 bin_sin[NUM_BINS];
+
+#endif
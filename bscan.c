@@ -0,0 +1,101 @@
+// bscan.c
+// Author: Joseph Dobrzanski
+// B-scan (range vs bearing) view of the point store. Each column is sent as one
+// CASET + RAMWR burst of _height pixels (RASET stays cached), so the link spends
+// its time on pixel data instead of address windows.
+// Call with lock_Sem held.
+
+#include "bscan.h"
+#include "layers.h"
+#include "coord.h"
+#include "spi_screen.h"
+
+// range of the live return of "bin" in polar view pixels at zoom_level, -1 if it has none
+int16 bscan_range(int16 bin)
+{
+    if (points_angle[bin] == NO_ANG_DATA) return -1;
+    return (int16)(((int32)coord_range(bin) * zoom_scales[zoom_level]) >> 8);
+}
+
+// screen row of range r (row _height - 1 is range 0)
+static int16 range_row(int16 r)
+{
+    return (_height - 1) - (int16)(((int32)r * (_height - 1)) / BSCAN_MAX_RANGE);
+}
+
+// rows of the range grid (every RING_STEP pixels of range), top row first
+static int16 grid_rows[BSCAN_RINGS];
+
+// paint the empty B-scan in one address window
+void bscan_draw(void)
+{
+    int16 x, y, ring;
+    int16 next = 0;
+    int color;
+
+    for (ring = 0; ring < BSCAN_RINGS; ring++) {
+        grid_rows[ring] = range_row((BSCAN_RINGS - ring) * RING_STEP);
+    }
+
+    _startWrite(0, 0, _width - 1, _height - 1);
+    for (y = 0; y < _height; y++) {
+        color = BACKGROUND_COLOR;
+        if ((next < BSCAN_RINGS) && (grid_rows[next] == y)) {
+            color = GRID_COLOR;
+            next++;
+        }
+        for (x = 0; x < _width; x++) {
+            _pushColor(color);
+        }
+    }
+}
+
+// stream one column from the returns of its bins. Rows are worked out before the
+// RAMWR run, so the loop only compares against the next grid row and return.
+static void bscan_column(int16 column)
+{
+    int16 first = BSCAN_FIRST_BIN(column);
+    int16 last = BSCAN_FIRST_BIN(column + 1) - 1;
+    int16 top = _height;        // rows [top, bottom] are a return
+    int16 bottom = -1;
+    int16 top2 = _height;       // second bin of the column
+    int16 bottom2 = -1;
+    int16 next = 0;
+    int16 bin, y, r, row;
+    int color;
+
+    for (bin = first; bin <= last; bin++) {
+        r = bscan_range(bin);
+        if ((r < 0) || (r > BSCAN_MAX_RANGE)) continue;
+        row = range_row(r);
+        if (bottom < 0) {
+            top = row - BSCAN_DOT_ROWS + 1;
+            bottom = row;
+        } else {
+            top2 = row - BSCAN_DOT_ROWS + 1;
+            bottom2 = row;
+        }
+    }
+
+    _startWrite(column, 0, column, _height - 1);
+    for (y = 0; y < _height; y++) {
+        color = BACKGROUND_COLOR;
+        if ((next < BSCAN_RINGS) && (grid_rows[next] == y)) {
+            color = GRID_COLOR;
+            next++;
+        }
+        if (((y >= top) && (y <= bottom)) || ((y >= top2) && (y <= bottom2))) {
+            color = TARGET_COLOR;
+        }
+        _pushColor(color);
+    }
+}
+
+// the sweep has left "bin": stream its column once all of the column's bins are done
+void bscan_bin_left(int16 bin)
+{
+    if (bin >= NUM_BINS) return;
+    if ((bin == NUM_BINS - 1) || (BSCAN_COLUMN(bin + 1) != BSCAN_COLUMN(bin))) {
+        bscan_column(BSCAN_COLUMN(bin));
+    }
+}
@@ -0,0 +1,26 @@
+// bscan.h
+// Author: Joseph Dobrzanski
+// B-scan view: bearing across (one screen column per ~1.7 encoder bins), range
+// up the panel. A column is streamed top to bottom as one address window once
+// the sweep has left all of its bins. Ranges follow the zoom level of the polar
+// view, so both views show the same returns.
+
+#ifndef BSCAN_H
+#define BSCAN_H
+
+#include "main_file.h"
+#include "layers.h"
+
+#define BSCAN_MAX_RANGE 65      // range shown at the top row, in polar view pixels at the current zoom
+#define BSCAN_DOT_ROWS  2       // rows drawn for each return
+#define BSCAN_RINGS     ((BSCAN_MAX_RANGE - 1) / RING_STEP) // range grid lines
+
+#define BSCAN_COLUMN(bin)   ((int16)(((int32)(bin) * _width) / NUM_BINS))
+
+#define BSCAN_FIRST_BIN(column) ((int16)(((int32)(column) * NUM_BINS + _width - 1) / _width))
+
+int16 bscan_range(int16 bin);
+void bscan_draw(void);
+void bscan_bin_left(int16 bin);
+
+#endif
@@ -0,0 +1,285 @@
+// contour.c
+// Author: Joseph Dobrzanski
+// Joins returns of neighbouring bins with integer Bresenham segments.
+// When a bin's return moves, appears or drops out, only the two segments that
+// touch it are updated: pixels of the old segments that the new ones do not
+// reuse are erased, pixels of the new segments that were not on screen yet are
+// drawn. Each batch is sorted by row so horizontal runs go out in one address
+// window. After contour_mode changes, contour_next_stale() hands out the bins whose
+// segments still follow the old mode, a few per tick, so static returns get
+// joined or unjoined too. Call with lock_Sem held.
+
+#include "contour.h"
+#include "render.h"
+#include "layers.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+// pixels relative to the disc center, 8 bits each, row-major so they sort by row
+#define PACK(x, y)      (((Uint16)((y) - DISC_Y + 128) << 8) | (Uint16)((x) - DISC_X + 128))
+#define UNPACK_X(px)    ((int16)((px) & 0xFF) + DISC_X - 128)
+#define UNPACK_Y(px)    ((int16)((px) >> 8) + DISC_Y - 128)
+#define FITS(x, y)      (((x) - DISC_X >= -128) && ((x) - DISC_X < 128) && ((y) - DISC_Y >= -128) && ((y) - DISC_Y < 128))
+#define PIXEL_SAME      0xFFFF  // marks a pixel that is on both the old and the new segments
+#define DRAWN_BIT(bin)  (1U << ((bin) & 0xF))
+
+int16 contour_mode = CONTOUR_MODE;
+
+static Uint16 contour_drawn[(NUM_BINS + 15) / 16];  // segments currently on screen
+static Uint16 batch[4 * CONTOUR_MAX_PX];            // old and new pixels of the two segments
+static int16 batch_len;
+static int16 walked_mode = (CONTOUR_MODE != 0);     // contour_mode the drawn segments follow
+static int16 walk_cursor = 0;                       // next bin the mode pass looks at
+static int16 walk_left = 0;                         // bins the pass still has to look at
+
+static int16 abs16(int16 v)
+{
+    return (v < 0) ? -v : v;
+}
+
+// distance of (x, y) from the disc center, max + 3/8 min (within 7 %)
+static int16 approx_range(int16 x, int16 y)
+{
+    int16 dx = abs16(x - DISC_X);
+    int16 dy = abs16(y - DISC_Y);
+    return (dx > dy) ? dx + (3*dy)/8 : dy + (3*dx)/8;
+}
+
+// true if the current returns of "bin" and the next bin are close enough to be joined
+static int segment_exists(int16 bin)
+{
+    int16 next = (bin + 1 < NUM_BINS) ? bin + 1 : 0;
+
+    HAL_COST(COST_CYCLES, 12);
+    if (!contour_mode || (bin >= NUM_BINS)) return 0;
+    if ((points_angle[bin] == NO_ANG_DATA) || (points_angle[next] == NO_ANG_DATA)) return 0;
+    HAL_COST(COST_CYCLES, 45);
+    if (abs16(points[bin][0] - points[next][0]) >= CONTOUR_MAX_PX) return 0;
+    if (abs16(points[bin][1] - points[next][1]) >= CONTOUR_MAX_PX) return 0;
+    return abs16(approx_range(points[bin][0], points[bin][1]) - approx_range(points[next][0], points[next][1])) <= CONTOUR_GAP;
+}
+
+// Bresenham from (x0, y0) to (x1, y1), either reporting whether (x, y) is on it (px == 0)
+// or appending its on-screen pixels to batch[] (at most two segments' worth per list: an
+// end point that changed under the caller can make a segment longer than CONTOUR_MAX_PX)
+static int segment_walk(int16 x0, int16 y0, int16 x1, int16 y1, int16 x, int16 y, Uint16 *px)
+{
+    int16 dx = abs16(x1 - x0);
+    int16 dy = abs16(y1 - y0);
+    int16 sx = (x1 < x0) ? -1 : 1;
+    int16 sy = (y1 < y0) ? -1 : 1;
+    int16 err = dx - dy;
+    int16 e2;
+
+    HAL_COST(COST_CYCLES, 20);
+    while (1) {
+        HAL_COST(COST_CYCLES, 14);
+        if (px == 0) {
+            if ((x0 == x) && (y0 == y)) return 1;
+        } else if ((batch_len < 2 * CONTOUR_MAX_PX) && (x0 >= 0) && (x0 < _width) && (y0 >= 0) && (y0 < _height) && FITS(x0, y0)) {
+            px[batch_len++] = PACK(x0, y0);
+            HAL_COST(COST_CYCLES, 10);
+        }
+        if ((x0 == x1) && (y0 == y1)) break;
+        e2 = 2*err;
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+    return 0;
+}
+
+// true if the segment from "bin" to the next bin runs through (x, y)
+int contour_covers(int16 bin, int16 x, int16 y)
+{
+    int16 next = (bin + 1 < NUM_BINS) ? bin + 1 : 0;
+    int16 x0, y0, x1, y1;
+
+    HAL_COST(COST_CYCLES, 12);
+    if (!contour_mode || (bin >= NUM_BINS)) return 0;
+    if ((points_angle[bin] == NO_ANG_DATA) || (points_angle[next] == NO_ANG_DATA)) return 0;
+    HAL_COST(COST_CYCLES, 16);
+    x0 = points[bin][0];
+    y0 = points[bin][1];
+    x1 = points[next][0];
+    y1 = points[next][1];
+    // bounding box first, most pixels are nowhere near the segment (the owner scan asks for
+    // every bin around the pixel, so the gap test only runs for the few that pass)
+    if ((x < x0 && x < x1) || (x > x0 && x > x1) || (y < y0 && y < y1) || (y > y0 && y > y1)) return 0;
+    if (!segment_exists(bin)) return 0;
+    return segment_walk(x0, y0, x1, y1, x, y, 0);
+}
+
+// insertion sort, a batch is at most a few dozen pixels
+static void batch_sort(Uint16 *px, int16 len)
+{
+    int16 i, j;
+    Uint16 v;
+
+    for (i = 1; i < len; i++) {
+        v = px[i];
+        HAL_COST(COST_CYCLES, 10);
+        for (j = i; (j > 0) && (px[j - 1] > v); j--) {
+            HAL_COST(COST_CYCLES, 8);
+            px[j] = px[j - 1];
+        }
+        px[j] = v;
+    }
+}
+
+// sort and drop duplicates, returns the new length
+static int16 batch_unique(Uint16 *px, int16 len)
+{
+    int16 i, n = 0;
+
+    batch_sort(px, len);
+    for (i = 0; i < len; i++) {
+        HAL_COST(COST_CYCLES, 8);
+        if ((n == 0) || (px[n - 1] != px[i])) px[n++] = px[i];
+    }
+    return n;
+}
+
+// send the pixels in px[] (sorted, no duplicates) as horizontal runs, each pixel in the
+// color of its best owner (or background layer)
+static void batch_send(const Uint16 *px, int16 len, int16 bin)
+{
+    int16 start, end, x, y;
+    Uint16 shade;
+
+    for (start = 0; start < len; start = end) {
+        end = start + 1;
+        HAL_COST(COST_CYCLES, 15);
+        while ((end < len) && (px[end] == px[end - 1] + 1) && (UNPACK_Y(px[end]) == UNPACK_Y(px[start]))) {
+            HAL_COST(COST_CYCLES, 10);
+            end++;
+        }
+        y = UNPACK_Y(px[start]);
+        _startWrite(UNPACK_X(px[start]), y, UNPACK_X(px[end - 1]), y);
+        for (x = UNPACK_X(px[start]); x <= UNPACK_X(px[end - 1]); x++) {
+            HAL_COST(COST_CYCLES, 10);
+            shade = pixel_shade(x, y, bin);
+            _pushColor((shade == SHADE_NONE) ? layer_color(x, y) : history_palette[shade]);
+        }
+    }
+}
+
+// drops the PIXEL_SAME marks and, when erasing, the pixels still owned by a live point
+// or segment (they keep their color), returns the new length
+static int16 batch_prune(Uint16 *px, int16 len, int erase, int16 bin)
+{
+    int16 i, n = 0;
+
+    for (i = 0; i < len; i++) {
+        HAL_COST(COST_CYCLES, 8);
+        if (px[i] == PIXEL_SAME) continue;
+        if (erase && (pixel_shade(UNPACK_X(px[i]), UNPACK_Y(px[i]), bin) < SHADE_GHOST)) continue;
+        px[n++] = px[i];
+    }
+    return n;
+}
+
+// the return of "bin" moved from (old_x, old_y), appeared or dropped out.
+// The point store must already hold the new state.
+void contour_point_moved(int16 bin, int16 old_x, int16 old_y)
+{
+    int16 prev = (bin + NUM_BINS - 1) % NUM_BINS;
+    int16 next = (bin + 1) % NUM_BINS;
+    int16 old_len, new_len, i, j;
+    Uint16 *old_px = batch;
+    Uint16 *new_px;
+
+    if (bin >= NUM_BINS) return;
+    HAL_COST(COST_DIV16, 2);
+    HAL_COST(COST_CYCLES, 40);
+
+    // old segments, as they were drawn (the other end has not moved)
+    batch_len = 0;
+    if (contour_drawn[prev >> 4] & DRAWN_BIT(prev)) {
+        segment_walk(points[prev][0], points[prev][1], old_x, old_y, 0, 0, old_px);
+    }
+    if (contour_drawn[bin >> 4] & DRAWN_BIT(bin)) {
+        segment_walk(old_x, old_y, points[next][0], points[next][1], 0, 0, old_px);
+    }
+    old_len = batch_len;
+
+    // new segments
+    new_px = &batch[old_len];
+    batch_len = 0;
+    contour_drawn[prev >> 4] &= ~DRAWN_BIT(prev);
+    contour_drawn[bin >> 4] &= ~DRAWN_BIT(bin);
+    if (segment_exists(prev)) {
+        contour_drawn[prev >> 4] |= DRAWN_BIT(prev);
+        segment_walk(points[prev][0], points[prev][1], points[bin][0], points[bin][1], 0, 0, new_px);
+    }
+    if (segment_exists(bin)) {
+        contour_drawn[bin >> 4] |= DRAWN_BIT(bin);
+        segment_walk(points[bin][0], points[bin][1], points[next][0], points[next][1], 0, 0, new_px);
+    }
+    new_len = batch_len;
+
+    // pixels on both the old and the new segments are already the right color
+    old_len = batch_unique(old_px, old_len);
+    new_len = batch_unique(new_px, new_len);
+    for (i = 0, j = 0; (i < old_len) && (j < new_len); ) {
+        HAL_COST(COST_CYCLES, 10);
+        if (old_px[i] < new_px[j]) {
+            i++;
+        } else if (old_px[i] > new_px[j]) {
+            j++;
+        } else {
+            old_px[i++] = PIXEL_SAME;
+            new_px[j++] = PIXEL_SAME;
+        }
+    }
+    batch_send(old_px, batch_prune(old_px, old_len, 1, bin), bin);
+    batch_send(new_px, batch_prune(new_px, new_len, 0, bin), bin);
+}
+
+// repaint the segment from "bin" to the next bin (its phosphor color changed)
+void contour_recolor(int16 bin)
+{
+    int16 next = (bin + 1) % NUM_BINS;
+
+    if ((bin >= NUM_BINS) || !(contour_drawn[bin >> 4] & DRAWN_BIT(bin))) return;
+    HAL_COST(COST_DIV16, 1);
+    batch_len = 0;
+    segment_walk(points[bin][0], points[bin][1], points[next][0], points[next][1], 0, 0, batch);
+    batch_send(batch, batch_unique(batch, batch_len), bin);
+}
+
+// the screen was wiped: no segment is drawn anymore
+void contour_reset(void)
+{
+    int16 index;
+    for (index = 0; index < (NUM_BINS + 15) / 16; index++) {
+        contour_drawn[index] = 0;
+    }
+}
+
+// next bin whose segment is drawn but should not be, or the other way round, since
+// contour_mode changed; -1 once the pass has gone round once. Pass the bin to
+// contour_point_moved() with its unchanged point to draw or erase the segment.
+int16 contour_next_stale(void)
+{
+    int16 bin;
+
+    if ((contour_mode != 0) != walked_mode) {
+        walked_mode = (contour_mode != 0);
+        walk_left = NUM_BINS; // start a new pass where the last one is
+    }
+    while (walk_left > 0) {
+        bin = walk_cursor;
+        walk_cursor = (walk_cursor + 1) % NUM_BINS;
+        walk_left--;
+        HAL_COST(COST_DIV16, 1);
+        HAL_COST(COST_CYCLES, 12);
+        if (((contour_drawn[bin >> 4] & DRAWN_BIT(bin)) != 0) != (segment_exists(bin) != 0)) return bin;
+    }
+    return -1;
+}
@@ -0,0 +1,26 @@
+// contour.h
+// Author: Joseph Dobrzanski
+// Optional contour mode: returns of neighbouring bins at about the same range are
+// joined with a line, so walls show up as solid arcs instead of dotted ones.
+// A segment belongs to the lower of its two bins and counts as a live owner of
+// its pixels in render.c.
+
+#ifndef CONTOUR_H
+#define CONTOUR_H
+
+#include "main_file.h"
+
+#define CONTOUR_MODE    1   // start-up value of contour_mode (0 = points only)
+#define CONTOUR_GAP     4   // max range difference (pixels) between two joined returns
+#define CONTOUR_MAX_PX  12  // longest segment (Chebyshev length + 1), longer gaps stay open
+#define CONTOUR_BINS_PER_TICK 4 // bins whose segments are drawn or erased per encoder tick after contour_mode changed
+
+extern int16 contour_mode; // can be changed through the "Expressions" watch list
+
+int contour_covers(int16 bin, int16 x, int16 y);
+void contour_point_moved(int16 bin, int16 old_x, int16 old_y);
+void contour_recolor(int16 bin);
+void contour_reset(void);
+int16 contour_next_stale(void);
+
+#endif
@@ -0,0 +1,227 @@
+// coord.c
+// Author: Joseph Dobrzanski
+// Polar to screen conversion (moved here from polar_to_cart_Fxn()) with a
+// runtime zoom level. Auto-ranging builds a histogram of the raw distances
+// seen during a sweep and, at the end of the sweep, picks the largest zoom that
+// still keeps ZOOM_FILL percent of the returns inside the view.
+// After a zoom change, bins still drawn with the old level are handed out by
+// coord_next_stale() a few per tick, so the panel is reprojected sector by sector.
+
+#include "coord.h"
+#include "spi_screen.h"
+#include "hal.h"
+#include "bin_trig.h"
+
+// pixels per distance unit of each zoom level (Q8: 256 = 1 pixel per unit)
+const Uint16 zoom_scales[ZOOM_LEVELS] = {64, 128, 256, 512, 1024};
+
+int16 zoom_select = ZOOM_AUTO;
+int16 zoom_level = ZOOM_DEFAULT;
+
+static struct coord_bin coord_bins[NUM_POINTS];
+static Uint16 range_hist[RANGE_BUCKETS];
+static Uint16 range_count = 0;
+static int16 stale_cursor = 0;      // next bin the reprojection pass looks at
+static int16 stale_left = 0;        // bins the pass still has to look at
+
+// screen coordinates of a return "distance" units away at "angle" (tenths of a degree),
+// "scale" pixels per unit (Q8). Sine and cosine use Bhaskara-style rational approximations.
+void coord_project(int16 distance, int32 angle, Uint16 scale, int16 *x, int16 *y)
+{
+    Uint32 temp_val; // used for intermediate steps
+    Uint32 dist;
+    int32 x_, y_, ref_ang;
+    int16 quadrant, x_quadrant_corr, y_quadrant_corr;
+
+    // the C28x has no divide instruction: 5 long divisions (RTS calls) and 11 long multiplies below
+    HAL_COST(COST_DIV32, 5);
+    HAL_COST(COST_MUL32, 11);
+    HAL_COST(COST_CYCLES, 40);
+
+    dist = ((Uint32)distance * scale + 128) >> 8;
+    if (dist > COORD_MAX_PX) dist = COORD_MAX_PX;
+
+    // find quadrant of angle
+    quadrant = angle/(SF*90);
+
+    // ensure coordinates put into correct quadrant and acquire reference angle
+    if (quadrant == 0) {         // from 0 - 90 degrees
+        x_quadrant_corr = 1;
+        y_quadrant_corr = 1;
+        ref_ang = angle;
+    } else if (quadrant == 1) {  // from 90 - 180 degrees
+        x_quadrant_corr = -1;
+        y_quadrant_corr = 1;
+        ref_ang = SF*180-angle;
+    } else if (quadrant == 2) {  // from 180 - 270 degrees
+        x_quadrant_corr = -1;
+        y_quadrant_corr = -1;
+        ref_ang = angle-SF*180;
+    } else {                     // from 270 - 360 degrees
+        x_quadrant_corr = 1;
+        y_quadrant_corr = -1;
+        ref_ang = SF*360-angle;
+    }
+
+    // calculate y coordinate with sine approximation
+    temp_val = SF*180 - ref_ang;
+    y_ = SF*dist*4*(Uint32)ref_ang*temp_val / (40500*SF*SF-((Uint32)ref_ang)*temp_val); // calculate sine approx
+    y_ = (y_+SF/2)/SF; // round value and scale back down
+
+    // calculate x coordinate with cosine approximation (ref_ang^2 / 16, or SF*dist*5*temp_val
+    // overflows 32 bits for far returns above 82 degrees)
+    temp_val = ((Uint32)ref_ang*(Uint32)ref_ang) >> 4;
+    x_ = SF*dist - SF*dist*5*temp_val / ((Uint32)32400*SF*SF/16 + temp_val); // calculate cosine approx
+    x_ = (x_ + SF/2)/SF; // round value and scale back down
+
+    // determine coordinate to display coordinates
+    *y = _height/2 + y_quadrant_corr*y_;
+    *x = _width/2 + x_quadrant_corr*x_;
+}
+
+// same as coord_project() from the Q14 cos/sin table of the encoder bins (bin_trig.c):
+// two 16 x 16 multiplies and no division, but only for angles on a bin
+void coord_project_table(int16 distance, int32 angle, Uint16 scale, int16 *x, int16 *y)
+{
+    Uint32 dist = ((Uint32)distance * scale + 128) >> 8;
+    int16 bin = (int16)(angle / ENCODER_ANG);
+
+    HAL_COST(COST_DIV32, 1);
+    HAL_COST(COST_CYCLES, 20);
+    if (dist > COORD_MAX_PX) dist = COORD_MAX_PX;
+    if (bin >= NUM_BINS) bin -= NUM_BINS;
+    *x = _width/2 + (int16)(((int32)dist * bin_cos[bin] + (1L << (TRIG_SHIFT - 1))) >> TRIG_SHIFT);
+    *y = _height/2 + (int16)(((int32)dist * bin_sin[bin] + (1L << (TRIG_SHIFT - 1))) >> TRIG_SHIFT);
+}
+
+// atan(2^-i) in 1/64 tenths of a degree
+static const int32 cordic_atan[CORDIC_STEPS] = {
+    28800, 17002, 8983, 4560, 2289, 1146, 573, 286, 143, 72, 36, 18, 9, 4
+};
+
+// same as coord_project() by CORDIC rotation: shifts and adds only, any angle
+void coord_project_cordic(int16 distance, int32 angle, Uint16 scale, int16 *x, int16 *y)
+{
+    Uint32 dist = ((Uint32)distance * scale + 128) >> 8;
+    int32 cx, cy, t, z;
+    int16 i, flip = 0;
+
+    if (dist > COORD_MAX_PX) dist = COORD_MAX_PX;
+    // rotate within -90..90 degrees, the other half is the mirror image
+    if ((angle > SF*90) && (angle < SF*270)) {
+        angle -= SF*180;
+        flip = 1;
+    } else if (angle >= SF*270) {
+        angle -= SF*360;
+    }
+    cx = (int32)dist << 8;
+    cy = 0;
+    z = angle * 64;
+    for (i = 0; i < CORDIC_STEPS; i++) {
+        t = cx;
+        if (z >= 0) {
+            cx -= cy >> i;
+            cy += t >> i;
+            z -= cordic_atan[i];
+        } else {
+            cx += cy >> i;
+            cy -= t >> i;
+            z += cordic_atan[i];
+        }
+    }
+    // remove the CORDIC gain (0.60725 in Q15) and the 8 fraction bits
+    cx = (cx * CORDIC_GAIN + (1L << 22)) >> 23;
+    cy = (cy * CORDIC_GAIN + (1L << 22)) >> 23;
+    HAL_COST(COST_MUL32, 2);
+    HAL_COST(COST_CYCLES, CORDIC_STEPS * 10 + 30);  // shifts, adds and a branch per step
+    if (flip) {
+        cx = -cx;
+        cy = -cy;
+    }
+    *x = _width/2 + (int16)cx;
+    *y = _height/2 + (int16)cy;
+}
+
+// "bin" got a new return of "distance" units
+void coord_store(int16 bin, int16 distance)
+{
+    if (distance < 0) distance = 0;
+    if (distance > 255) distance = 255;
+    coord_bins[bin].range = distance;
+}
+
+// raw distance of the last return of "bin"
+int16 coord_range(int16 bin)
+{
+    return coord_bins[bin].range;
+}
+
+// true if what "bin" has on screen was drawn with another zoom level. The bin counts as
+// drawn with zoom_level from now on.
+int16 coord_rescaled(int16 bin)
+{
+    if (coord_bins[bin].level == zoom_level) return 0;
+    coord_bins[bin].level = zoom_level;
+    return 1;
+}
+
+// screen position of the live return of "bin" at zoom_level
+void coord_reproject(int16 bin, int16 *x, int16 *y)
+{
+    coord_project(coord_bins[bin].range, points_angle[bin], zoom_scales[zoom_level], x, y);
+}
+
+// next bin still drawn with an old zoom level, -1 once the pass has gone round once
+int16 coord_next_stale(void)
+{
+    int16 bin;
+
+    while (stale_left > 0) {
+        bin = stale_cursor;
+        stale_cursor = (stale_cursor + 1) % NUM_POINTS;
+        stale_left--;
+        if (coord_bins[bin].level != zoom_level) return bin;
+    }
+    return -1;
+}
+
+// the sweep has left "bin": count its return, and after the last bin pick the zoom level
+void coord_bin_left(int16 bin)
+{
+    int16 level, bucket;
+    Uint16 covered, limit;
+    int16 old_level = zoom_level;
+
+    if (points_angle[bin] != NO_ANG_DATA) {
+        range_hist[coord_bins[bin].range / (256 / RANGE_BUCKETS)]++;
+        range_count++;
+    }
+    if (bin != NUM_BINS - 1) return;
+
+    if (zoom_select != ZOOM_AUTO) {
+        zoom_level = (zoom_select < 0) ? 0 : (zoom_select >= ZOOM_LEVELS) ? ZOOM_LEVELS - 1 : zoom_select;
+    } else if (range_count > 0) {
+        // smallest distance that covers ZOOM_FILL percent of the returns (bucket upper edge)
+        limit = (Uint16)(((Uint32)range_count * ZOOM_FILL + 99) / 100);
+        covered = 0;
+        for (bucket = 0; bucket < RANGE_BUCKETS - 1; bucket++) {
+            covered += range_hist[bucket];
+            if (covered >= limit) break;
+        }
+        // largest zoom that keeps that distance inside the view
+        for (level = ZOOM_LEVELS - 1; level > 0; level--) {
+            if ((((Uint32)(bucket + 1) * (256 / RANGE_BUCKETS) * zoom_scales[level]) >> 8) <= ZOOM_VIEW_R) break;
+        }
+        zoom_level = level;
+    }
+    if (zoom_level != old_level) {
+        // reproject one lap, starting where the new sweep starts
+        stale_cursor = 0;
+        stale_left = NUM_POINTS;
+    }
+
+    for (bucket = 0; bucket < RANGE_BUCKETS; bucket++) {
+        range_hist[bucket] = 0;
+    }
+    range_count = 0;
+}
@@ -0,0 +1,48 @@
+// coord.h
+// Author: Joseph Dobrzanski
+// Polar to screen conversion with runtime zoom. Each bin remembers its raw
+// distance and the zoom level its point was projected with, so a zoom change
+// can be applied bin by bin as the sweep passes instead of in one blocking repaint.
+
+#ifndef COORD_H
+#define COORD_H
+
+#include "main_file.h"
+#include "layers.h"
+
+#define ZOOM_LEVELS     5
+#define ZOOM_DEFAULT    2       // index of 1 pixel per distance unit in zoom_scales[]
+#define ZOOM_AUTO       -1      // zoom_select value for auto-ranging
+#define ZOOM_VIEW_R     (DISC_R - RIM_WIDTH - 1)    // pixels from the center to just inside the rim
+#define ZOOM_FILL       90      // auto-ranging fits this percentage of the returns into the view
+#define ZOOM_BINS_PER_TICK 2    // bins reprojected per encoder tick after a zoom change (a lap takes NUM_POINTS/2 ticks)
+#define COORD_MAX_PX    127     // projected distances are capped here (off the disc, keeps the math in 32 bits)
+#define RANGE_BUCKETS   16      // histogram of raw distances for auto-ranging (16 units per bucket)
+#define CORDIC_STEPS    14      // coord_project_cordic() iterations
+#define CORDIC_GAIN     19898L  // 1 / CORDIC gain in Q15
+#define COORD_BUDGET_MAX 10     // error budget of a conversion backend, tenths of a pixel from the exact point:
+#define COORD_BUDGET_RMS 5      //   worst case and RMS over all bins, distances and zoom levels (host/coord_check.c)
+
+// per-bin projection state (1 word)
+struct coord_bin {
+    Uint16 range:8;     // raw distance of the bin's return
+    Uint16 level:4;     // zoom level its point is drawn with
+    Uint16 rsvd:4;
+};
+
+extern const Uint16 zoom_scales[ZOOM_LEVELS];
+extern int16 zoom_select;   // ZOOM_AUTO or a fixed level, can be changed through the "Expressions" watch list
+extern int16 zoom_level;    // level new points are projected with
+
+void coord_project(int16 distance, int32 angle, Uint16 scale, int16 *x, int16 *y);
+// other ways to do the same conversion, compared in the host build (host/bench.c)
+void coord_project_table(int16 distance, int32 angle, Uint16 scale, int16 *x, int16 *y);
+void coord_project_cordic(int16 distance, int32 angle, Uint16 scale, int16 *x, int16 *y);
+void coord_store(int16 bin, int16 distance);
+int16 coord_range(int16 bin);
+int16 coord_rescaled(int16 bin);
+void coord_reproject(int16 bin, int16 *x, int16 *y);
+int16 coord_next_stale(void);
+void coord_bin_left(int16 bin);
+
+#endif
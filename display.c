@@ -0,0 +1,27 @@
+// display.c
+// Author: Joseph Dobrzanski
+// Selected display driver. The panel backends (ST7735, ST7789, ILI9341) are in
+// spi_screen.c, the framebuffer backend in display_mem.c.
+
+#include "display.h"
+
+// the disc of DISPLAY_DRIVER (half its shorter side) has to fit the buffers sized by
+// DISPLAY_MAX_R: this fails to compile (negative array size) if it does not. Drivers
+// selected at run time are checked by display_select().
+typedef char display_max_r_check[(DISPLAY_MIN_SIDE/2 <= DISPLAY_MAX_R) ? 1 : -1];
+
+const struct display_driver *display = &DISPLAY_DRIVER;
+
+// use "driver" from now on (call before screen_begin()). A driver without a size, or whose
+// disc does not fit the buffers sized by DISPLAY_MAX_R, is refused (-1) and the selected
+// driver stays.
+int16 display_select(const struct display_driver *driver)
+{
+    int16 side;
+
+    if ((driver == 0) || (driver->width <= 0) || (driver->height <= 0)) return -1;
+    side = (driver->width < driver->height) ? driver->width : driver->height;
+    if (side/2 > DISPLAY_MAX_R) return -1;
+    display = driver;
+    return 0;
+}
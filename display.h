@@ -0,0 +1,61 @@
+// display.h
+// Author: Joseph Dobrzanski
+// Display driver interface. Everything that reaches the panel goes through an
+// address window followed by a pixel stream or fill, so a backend only has to
+// provide these few operations. DISPLAY_DRIVER is the driver at boot; another one
+// (display_mem.c, with its geometry set at run time) can be selected with
+// display_select() before main() configures the screen. _width/_height in
+// spi_screen.h read the geometry of the selected driver through "display".
+
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include "Peripheral_Headers/F2802x_Device.h"
+
+// largest disc the static buffers are sized for (sweep line, ghost and contour pixels
+// are stored relative to the disc center in 8 bits each, so DISPLAY_MAX_R <= 127).
+// display_select() refuses a driver whose disc is larger.
+// 65 fits the ST7735 (130 / 2); use 120 for the 240-pixel-high ST7789/ILI9341 panels.
+#ifndef DISPLAY_MAX_R
+#define DISPLAY_MAX_R   65
+#endif
+
+// panel sizes of the drivers in spi_screen.c, named after the driver so the size of
+// DISPLAY_DRIVER can be looked up at compile time (DISPLAY_MIN_SIDE below)
+#define display_st7735_W    130
+#define display_st7735_H    130
+#define display_st7789_W    240
+#define display_st7789_H    240
+#define display_ili9341_W   320
+#define display_ili9341_H   240
+
+struct display_driver {
+    const char *name;
+    int16 width;            // visible columns
+    int16 height;           // visible rows
+    int16 gram_rows;        // display RAM rows for vertical scrolling, 0 = cannot scroll rows
+    void (*begin)(void);                                        // power up and configure the panel
+    void (*window)(int16 x0, int16 y0, int16 x1, int16 y1);    // open an address window for writing
+    void (*push)(Uint16 color);                                 // next pixel of the window
+    void (*fill)(Uint16 color, Uint32 count);                   // next "count" pixels in one color
+    void (*scroll_area)(int16 top, int16 rows, int16 bottom);  // fixed top, scrolling, fixed bottom rows
+    void (*scroll)(int16 line);                                 // RAM row shown at the top of the scroll area
+};
+
+extern const struct display_driver display_st7735;     // 130x130 (this project's panel)
+extern const struct display_driver display_st7789;     // 240x240
+extern const struct display_driver display_ili9341;    // 320x240, landscape
+
+#ifndef DISPLAY_DRIVER
+#define DISPLAY_DRIVER  display_st7735
+#endif
+
+#define DISPLAY_SIZE_OF(driver, side)   driver##_##side
+#define DISPLAY_SIZE(driver, side)      DISPLAY_SIZE_OF(driver, side)   // expands DISPLAY_DRIVER first
+#define DISPLAY_MIN_SIDE    ((DISPLAY_SIZE(DISPLAY_DRIVER, W) < DISPLAY_SIZE(DISPLAY_DRIVER, H)) ? DISPLAY_SIZE(DISPLAY_DRIVER, W) : DISPLAY_SIZE(DISPLAY_DRIVER, H))
+
+extern const struct display_driver *display;
+
+int16 display_select(const struct display_driver *driver);
+
+#endif
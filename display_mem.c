@@ -0,0 +1,97 @@
+// display_mem.c
+// Author: Joseph Dobrzanski
+// Display backend that draws into a framebuffer in memory instead of a panel,
+// for running the rendering code off target (host/sim -P). It keeps the same
+// window/RAM write semantics as the DCS panels (pixels fill the window left to
+// right, top to bottom, and wrap inside it) and adds the bytes a DCS panel would
+// be sent to spi_byte_count (and to the host cost model), so the tick budgets in
+// main_file.c behave the same.
+// The geometry is whatever display_mem_init() is given at run time.
+
+#include "display_mem.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+#define MEM_WINDOW_BYTES    11  // CASET and RASET with 4 data bytes each, RAMWR
+
+static Uint16 *mem_fb = 0;
+static int16 mem_x0, mem_y0, mem_x1, mem_y1;   // open window
+static int16 mem_x, mem_y;                      // next pixel of the window
+
+Uint32 mem_windows = 0;     // windows opened
+Uint32 mem_pixels = 0;      // pixels written
+int16 mem_scroll_line = 0;  // RAM row shown at the top of the panel
+
+static void mem_begin(void)
+{
+    mem_windows = 0;
+    mem_pixels = 0;
+    mem_scroll_line = 0;
+}
+
+static void mem_window(int16 x0, int16 y0, int16 x1, int16 y1)
+{
+    mem_x0 = x0;
+    mem_y0 = y0;
+    mem_x1 = x1;
+    mem_y1 = y1;
+    mem_x = x0;
+    mem_y = y0;
+    mem_windows++;
+    spi_byte_count += MEM_WINDOW_BYTES;
+    HAL_COST(COST_SPI_BYTE, MEM_WINDOW_BYTES);
+}
+
+static void mem_push(Uint16 color)
+{
+    if ((mem_fb != 0) && (mem_x >= 0) && (mem_x < display_mem.width) && (mem_y >= 0) && (mem_y < display_mem.gram_rows)) {
+        mem_fb[(Uint32)mem_y * display_mem.width + mem_x] = color;
+    }
+    mem_pixels++;
+    spi_byte_count += 2;
+    HAL_COST(COST_SPI_BYTE, 2);
+    if (++mem_x > mem_x1) {
+        mem_x = mem_x0;
+        if (++mem_y > mem_y1) mem_y = mem_y0;
+    }
+}
+
+static void mem_fill(Uint16 color, Uint32 count)
+{
+    while (count-- > 0) {
+        mem_push(color);
+    }
+}
+
+static void mem_scroll_area(int16 top, int16 rows, int16 bottom)
+{
+}
+
+static void mem_scroll(int16 line)
+{
+    mem_scroll_line = line;
+}
+
+struct display_driver display_mem = {
+    "memory", 0, 0, 0, mem_begin, mem_window, mem_push, mem_fill, mem_scroll_area, mem_scroll
+};
+
+// draw into "fb" (width*height pixels, row-major) as a width x height panel.
+// The whole buffer scrolls (gram_rows = height).
+void display_mem_init(Uint16 *fb, int16 width, int16 height)
+{
+    mem_fb = fb;
+    display_mem.width = width;
+    display_mem.height = height;
+    display_mem.gram_rows = height;
+}
+
+// color shown at (x, y), with the scroll applied
+Uint16 display_mem_pixel(int16 x, int16 y)
+{
+    int16 row;
+
+    if ((mem_fb == 0) || (x < 0) || (x >= display_mem.width) || (y < 0) || (y >= display_mem.height)) return 0;
+    row = (y + mem_scroll_line) % display_mem.gram_rows;
+    return mem_fb[(Uint32)row * display_mem.width + x];
+}
@@ -0,0 +1,19 @@
+// display_mem.h
+// Author: Joseph Dobrzanski
+// Framebuffer display backend with its geometry set at run time (see display_mem.c).
+
+#ifndef DISPLAY_MEM_H
+#define DISPLAY_MEM_H
+
+#include "display.h"
+
+extern Uint32 mem_windows;
+extern Uint32 mem_pixels;
+extern int16 mem_scroll_line;
+
+extern struct display_driver display_mem;
+
+void display_mem_init(Uint16 *fb, int16 width, int16 height);
+Uint16 display_mem_pixel(int16 x, int16 y);
+
+#endif
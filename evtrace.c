@@ -0,0 +1,200 @@
+// evtrace.c
+// Author: Joseph Dobrzanski
+// Hook functions and RAM ring of the thread event trace (evtrace.h). The hooks
+// keep a small stack of what is running (a task, the Swi on top of it, an Hwi
+// on top of that) and charge the time since the previous event to the top of
+// it. The dump is sent from the idle thread like the input trace (trace.c),
+// and not while that one is being sent.
+
+#include "evtrace.h"
+#include "trace.h"
+#include "hal.h"
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <ti/sysbios/family/c28/Hwi.h>
+#include <ti/sysbios/knl/Swi.h>
+#include <ti/sysbios/knl/Task.h>
+
+// the flags are in every build: the other SCI TX reports wait while "evtrace_dump" is set
+int16 evtrace_enable = 1;
+int16 evtrace_dump = 0;
+
+#if DIAG_BUILD
+
+/* Hwi, Swi and Task handles defined in main_file.cfg */
+extern const Hwi_Handle hwi0;
+extern const Hwi_Handle hwi1;
+extern const Swi_Handle mySwi;
+extern const Task_Handle draw_point;
+extern const Task_Handle clear_point;
+extern const Task_Handle redraw_point;
+
+Uint32 evtrace_cycles[EVTRACE_THREADS];
+Uint16 evtrace_load[EVTRACE_THREADS];
+
+static Uint16 ring[EVTRACE_RECORDS * EVTRACE_WORDS];
+static Uint16 head = 0;     // next record written
+static Uint16 used = 0;     // records in the ring
+static Uint16 running[EVTRACE_DEPTH] = { EVTRACE_IDLE };
+static Uint16 depth = 0;    // index of the thread on the CPU in running[]
+static Uint32 last_time = 0;
+static Uint32 window = 0;   // Timestamp counts per evtrace_load[] window
+static Uint32 window_start = 0;
+static Uint32 window_cycles[EVTRACE_THREADS];
+static Uint16 dump_pos = 0; // next dump byte
+static Uint16 dump_len = 0;
+static Uint32 dump_freq = 0;
+
+// "freq" Timestamp counts per second
+void evtrace_init(Uint32 freq)
+{
+    window = freq / 1000 * EVTRACE_WINDOW_MS;
+    last_time = window_start = Timestamp_get32();
+}
+
+// time since the last event goes to the thread that had the CPU; call with interrupts disabled
+static void account(void)
+{
+    Uint32 now = Timestamp_get32();
+    Uint16 id;
+
+    evtrace_cycles[running[depth]] += now - last_time;
+    window_cycles[running[depth]] += now - last_time;
+    last_time = now;
+    if ((window != 0) && (now - window_start >= window)) {
+        for (id = 0; id < EVTRACE_THREADS; id++) {
+            evtrace_load[id] = (Uint16)(window_cycles[id] / (window / 100));
+            window_cycles[id] = 0;
+        }
+        window_start = now;
+    }
+}
+
+static void record(Uint16 thread, Uint16 event)
+{
+    Uint16 *r;
+
+    if (!evtrace_enable || evtrace_dump) return;
+    r = &ring[head * EVTRACE_WORDS];
+    r[0] = (Uint16)(last_time >> 16);
+    r[1] = (Uint16)last_time;
+    r[2] = (thread << 8) | event;
+    head = (head + 1) % EVTRACE_RECORDS;
+    if (used < EVTRACE_RECORDS) used++;
+}
+
+static Uint16 task_id(Task_Handle task)
+{
+    if (task == draw_point) return EVTRACE_DRAW;
+    if (task == clear_point) return EVTRACE_CLEAR;
+    if (task == redraw_point) return EVTRACE_REDRAW;
+    return EVTRACE_IDLE;    // the Idle task is the only other one
+}
+
+static void begin(Uint16 id)
+{
+    UInt key = Hwi_disable();
+
+    account();
+    if (depth < EVTRACE_DEPTH - 1) depth++;
+    running[depth] = id;
+    record(id, EVTRACE_BEGIN);
+    Hwi_restore(key);
+}
+
+static void end(Uint16 id)
+{
+    UInt key = Hwi_disable();
+
+    account();
+    if (depth > 0) depth--;
+    record(id, EVTRACE_END);
+    Hwi_restore(key);
+}
+
+// hook sets (main_file.cfg)
+Void evtrace_hwi_begin(Hwi_Handle hwi)
+{
+    begin((hwi == hwi0) ? EVTRACE_ENCODER : (hwi == hwi1) ? EVTRACE_IR : EVTRACE_OTHER);
+}
+
+Void evtrace_hwi_end(Hwi_Handle hwi)
+{
+    end((hwi == hwi0) ? EVTRACE_ENCODER : (hwi == hwi1) ? EVTRACE_IR : EVTRACE_OTHER);
+}
+
+Void evtrace_swi_begin(Swi_Handle swi)
+{
+    begin((swi == mySwi) ? EVTRACE_SWI : EVTRACE_OTHER);
+}
+
+Void evtrace_swi_end(Swi_Handle swi)
+{
+    end((swi == mySwi) ? EVTRACE_SWI : EVTRACE_OTHER);
+}
+
+Void evtrace_task_switch(Task_Handle prev, Task_Handle next)
+{
+    UInt key = Hwi_disable();
+    Uint16 id = task_id(next);
+
+    account();
+    running[0] = id;
+    record(id, EVTRACE_SWITCH);
+    Hwi_restore(key);
+}
+
+// byte "pos" of the dump
+static Uint16 dump_byte(Uint16 pos)
+{
+    Uint16 index, *r;
+
+    switch (pos) {
+    case 0: return 'L';
+    case 1: return 'E';
+    case 2: return 'V';
+    case 3: return '1';
+    case 4: return (Uint16)(dump_freq >> 24) & 0xFF;
+    case 5: return (Uint16)(dump_freq >> 16) & 0xFF;
+    case 6: return (Uint16)(dump_freq >> 8) & 0xFF;
+    case 7: return (Uint16)dump_freq & 0xFF;
+    case 8: return dump_len >> 8;
+    case 9: return dump_len & 0xFF;
+    }
+    pos -= EVTRACE_HEADER;
+    index = (head + EVTRACE_RECORDS - dump_len + pos / EVTRACE_RECORD_BYTES) % EVTRACE_RECORDS;
+    r = &ring[index * EVTRACE_WORDS];
+    switch (pos % EVTRACE_RECORD_BYTES) {
+    case 0: return r[0] >> 8;
+    case 1: return r[0] & 0xFF;
+    case 2: return r[1] >> 8;
+    case 3: return r[1] & 0xFF;
+    case 4: return r[2] >> 8;
+    }
+    return r[2] & 0xFF;
+}
+
+// call from the idle thread: sends the next dump bytes while "evtrace_dump" is set
+void evtrace_dump_tick(void)
+{
+    Types_FreqHz freq;
+
+    if (!evtrace_dump || trace_dump) return;
+    if (dump_pos == 0) {
+        Timestamp_getFreq(&freq);
+        dump_freq = freq.lo;
+        dump_len = used;
+    }
+    while ((dump_pos < EVTRACE_HEADER + dump_len * EVTRACE_RECORD_BYTES) && HAL_SCI_TX_READY()) {
+        HAL_SCI_TX_BYTE(dump_byte(dump_pos));
+        dump_pos++;
+    }
+    if (dump_pos == EVTRACE_HEADER + dump_len * EVTRACE_RECORD_BYTES) {
+        // start a new recording
+        used = 0;
+        dump_pos = 0;
+        evtrace_dump = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,60 @@
+// evtrace.h
+// Author: Joseph Dobrzanski
+// Thread event trace and per-thread CPU time, fed by the Hwi, Swi and Task hook
+// sets in main_file.cfg. Every Hwi/Swi begin and end and every task switch is
+// a fixed-size record (Timestamp, thread, event) in a RAM ring, and the time
+// between two events is added to the thread that had the CPU. This replaces
+// watching the CPU measurement pin on a scope. Setting "evtrace_dump" sends the
+// ring over SCI TX; host/ctrace turns the dump into a Chrome trace (JSON).
+//
+// The ring, the per-thread times and the hooks are built only with DIAG_BUILD
+// (main_file.h), and main_file.cfg only registers the hook sets with the
+// matching --cfgArgs, so a normal build pays nothing per interrupt.
+//
+// Dump: "LEV1", Timestamp frequency (4 bytes), record count (2 bytes), then the
+// records, oldest first: Timestamp (4 bytes), thread, event. Big-endian.
+
+#ifndef EVTRACE_H
+#define EVTRACE_H
+
+#include "main_file.h"
+
+// thread IDs
+#define EVTRACE_IDLE        0   // the Idle task (myIdleFxn)
+#define EVTRACE_ENCODER     1   // hwi0, encoder_Fxn
+#define EVTRACE_IR          2   // hwi1, IR_Fxn
+#define EVTRACE_SWI         3   // mySwi, polar_to_cart_Fxn
+#define EVTRACE_DRAW        4   // draw_point
+#define EVTRACE_CLEAR       5   // clear_point
+#define EVTRACE_REDRAW      6   // redraw_point
+#define EVTRACE_OTHER       7   // anything else
+#define EVTRACE_THREADS     8
+
+// events
+#define EVTRACE_BEGIN       0   // Hwi or Swi starts
+#define EVTRACE_END         1   // Hwi or Swi returns
+#define EVTRACE_SWITCH      2   // task switch, the record's thread is the new task
+
+#ifndef EVTRACE_RECORDS
+#define EVTRACE_RECORDS     128     // ring size, 3 words per record: 384 words
+#endif
+#define EVTRACE_WORDS       3
+#define EVTRACE_DEPTH       3       // task, Swi and Hwi on top of each other (Hwis do not nest)
+#define EVTRACE_WINDOW_MS   500     // evtrace_load[] window
+#define EVTRACE_HEADER      10      // dump bytes before the records
+#define EVTRACE_RECORD_BYTES 6
+
+extern int16 evtrace_enable;    // can be changed through the "Expressions" watch list
+extern int16 evtrace_dump;      // set to 1 through the "Expressions" watch list to send the ring, back to 0 when sent
+extern Uint32 evtrace_cycles[EVTRACE_THREADS]; // Timestamp counts used by each thread (wraps), DIAG_BUILD only
+extern Uint16 evtrace_load[EVTRACE_THREADS];   // percent of the last window used by each thread, DIAG_BUILD only
+
+#if DIAG_BUILD
+void evtrace_init(Uint32 freq);
+void evtrace_dump_tick(void);
+#else
+#define evtrace_init(freq)          ((void)(freq))
+#define evtrace_dump_tick()         ((void)(evtrace_dump = 0))  // no ring to send
+#endif
+
+#endif
@@ -0,0 +1,19 @@
+// hal.c
+// Author: Joseph Dobrzanski
+// C2000 side of hal.h (not part of the host build).
+
+#include "hal.h"
+
+// send one byte on SPIA and return the byte clocked in
+Uint16 hal_spi_send(Uint16 data)
+{
+    // put information into SPI buffer
+    while(SpiaRegs.SPISTS.bit.BUFFULL_FLAG == 1)
+    {
+    }
+    SpiaRegs.SPITXBUF = data << 8;
+    while(SpiaRegs.SPISTS.bit.INT_FLAG != 1)
+    {
+    }
+    return(SpiaRegs.SPIRXBUF & 0xFF);
+}
@@ -0,0 +1,52 @@
+// hal.h
+// Author: Joseph Dobrzanski
+// Hardware access used by the application code (screen control pins, SPIA,
+// SCIA, CPU load pin). On the C2000 these are the peripheral
+// registers; the host simulation build (host/, HOST_BUILD) supplies its own
+// versions so the same sources compile with gcc.
+
+#ifndef HAL_H
+#define HAL_H
+
+#ifdef HOST_BUILD
+#include "hal_host.h"
+#else
+#include "Peripheral_Headers/F2802x_Device.h"
+
+// CPU utilization pin (GPIO6), watched on an oscilloscope: high while idle.
+// It used to be GPIO7, which is also the screen select below; see evtrace.h for per-thread times
+#define HAL_CPU_IDLE()      (GpioDataRegs.GPASET.bit.GPIO6 = 1)
+#define HAL_CPU_BUSY()      (GpioDataRegs.GPACLEAR.bit.GPIO6 = 1)
+
+// screen control: GPIO2 is D/C (low = command), GPIO7 selects the screen
+#define HAL_LCD_COMMAND()   (GpioDataRegs.GPACLEAR.bit.GPIO2 = 1)
+#define HAL_LCD_DATA()      (GpioDataRegs.GPASET.bit.GPIO2 = 1)
+#define HAL_LCD_SELECT()    (GpioDataRegs.GPACLEAR.bit.GPIO7 = 1)
+
+// SCIA receive FIFO (distance samples) and transmit FIFO (trace dumps, GPIO29)
+#define HAL_SCI_RX_READY()  (SciaRegs.SCIFFRX.bit.RXFFST >= 1)
+#define HAL_SCI_RX_BYTE()   (SciaRegs.SCIRXBUF.bit.RXDT)
+#define HAL_SCI_TX_READY()  (SciaRegs.SCIFFTX.bit.TXFFST < 4)
+#define HAL_SCI_TX_BYTE(b)  (SciaRegs.SCITXBUF = (b))
+#define HAL_SCI_RX_OVERRUN() (SciaRegs.SCIFFRX.bit.RXFFOVF)
+#define HAL_SCI_RX_OVERRUN_CLEAR() (SciaRegs.SCIFFRX.bit.RXFFOVRCLR = 1)
+
+// CPU timer 1 as a free-running cycle counter for the self-test (selftest.c);
+// main_file.cfg leaves it alone (the Clock module is disabled)
+#define HAL_TIMER_START()   (CpuTimer1Regs.TCR.bit.TSS = 1, CpuTimer1Regs.PRD.all = 0xFFFFFFFF, \
+                             CpuTimer1Regs.TPR.all = 0, CpuTimer1Regs.TPRH.all = 0, \
+                             CpuTimer1Regs.TCR.bit.TRB = 1, CpuTimer1Regs.TCR.bit.TSS = 0)
+#define HAL_TIMER_CYCLES()  (0xFFFFFFFFUL - CpuTimer1Regs.TIM.all)
+#define HAL_TIMER_STOP()    (CpuTimer1Regs.TCR.bit.TSS = 1)
+
+// GPIO34 (switch S1.1 on the LaunchPad) low at start-up: run the self-test
+#define HAL_SELFTEST_PIN()  (GpioDataRegs.GPBDAT.bit.GPIO34 == 0)
+
+// busy-wait delays and the cost of slow arithmetic (host/cost.h) are modeled by the host build
+#define HAL_DELAY_HOOK(ticks)
+#define HAL_COST(op, n)
+#endif
+
+Uint16 hal_spi_send(Uint16 data);
+
+#endif
@@ -0,0 +1,215 @@
+// bench.c
+// Author: Joseph Dobrzanski
+// Micro-benchmarks of the hot kernels in the host build: the coordinate
+// conversion backends (coord.c), the screen primitives, the SCI sample path
+// and the point store update. Every kernel is run in batches; the host time
+// per call is the median of the batches (with the median absolute deviation
+// as its spread), and one batch is also measured in modeled C28x cycles and
+// SPI bytes (cost.h), which do not depend on the host. The modeled cycles only
+// cover what the code charges with HAL_COST() and the host HAL; the idle pass
+// itself is charged by the scheduler, so sci_idle models as free.
+//
+//   bench [-r repeats] [-o results.json] [-t label] [kernel ...]
+//
+// -o writes one JSON object per kernel, tagged with -t (a commit id, say), so
+// results can be collected per commit. On the target the same kernels are
+// timed with the CPU timer by the boot-time self-test.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal.h"
+#include "main_file.h"
+#include "coord.h"
+#include "spi_screen.h"
+#include "bios_host.h"
+#include "vpanel.h"
+
+#define BENCH_REPEATS   21      // batches per kernel (odd, for the median)
+#define BENCH_BATCH_NS  2000000 // batches are sized to take about this long
+
+extern int firmware_main(void);
+extern Void encoder_Fxn(Void);
+extern Void myIdleFxn(Void);
+extern Void polar_to_cart_Fxn(UArg arg);
+extern int16 distance;
+extern int32 angle;
+
+struct kernel {
+    const char *name;
+    void (*fxn)(unsigned long i);
+};
+
+static volatile int16 sink;
+
+// one conversion per call, every bin and every raw distance in turn
+static void convert_approx(unsigned long i)
+{
+    int16 x, y;
+    coord_project(i & 0xFF, ((i >> 8) % NUM_BINS) * ENCODER_ANG, 256, &x, &y);
+    sink = x + y;
+}
+
+static void convert_table(unsigned long i)
+{
+    int16 x, y;
+    coord_project_table(i & 0xFF, ((i >> 8) % NUM_BINS) * ENCODER_ANG, 256, &x, &y);
+    sink = x + y;
+}
+
+static void convert_cordic(unsigned long i)
+{
+    int16 x, y;
+    coord_project_cordic(i & 0xFF, ((i >> 8) % NUM_BINS) * ENCODER_ANG, 256, &x, &y);
+    sink = x + y;
+}
+
+static void draw_pixel(unsigned long i)
+{
+    drawPixel(20 + (i & 63), 20 + ((i >> 6) & 63), (i & 1) ? TARGET_COLOR : BACKGROUND_COLOR);
+}
+
+static void fill_rect(unsigned long i)
+{
+    fillRect(20 + (i & 31), 20 + ((i >> 5) & 31), 10, 10, (i & 1) ? TARGET_COLOR : BACKGROUND_COLOR);
+}
+
+static void draw_circle(unsigned long i)
+{
+    drawCircle(_width / 2, _height / 2, 18, 20, BACKGROUND_COLOR, (i & 1) ? TARGET_COLOR : BACKGROUND_COLOR);
+}
+
+// one pass of the idle loop with nothing in the SCI FIFO
+static void sci_idle(unsigned long i)
+{
+    myIdleFxn();
+}
+
+// a distance byte arrives: the idle loop reads it and the Swi stores the point
+static void sci_sample(unsigned long i)
+{
+    if ((i & 7) == 0) encoder_Fxn();
+    hal_sci_write(30 + (i & 15));
+    myIdleFxn();
+}
+
+// the Swi alone, a new return for the next bin on each call
+static void point_store(unsigned long i)
+{
+    encoder_Fxn();
+    distance = 30 + (i & 15);
+    polar_to_cart_Fxn(0);
+}
+
+static const struct kernel kernels[] = {
+    { "convert_approx", convert_approx },
+    { "convert_table", convert_table },
+    { "convert_cordic", convert_cordic },
+    { "drawPixel", draw_pixel },
+    { "fillRect_10x10", fill_rect },
+    { "drawCircle_r20", draw_circle },
+    { "sci_idle", sci_idle },
+    { "sci_sample", sci_sample },
+    { "point_store", point_store },
+};
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double batch_ns(const struct kernel *k, unsigned long n, unsigned long *next)
+{
+    double t0 = now_ns();
+    unsigned long i;
+
+    for (i = 0; i < n; i++) k->fxn((*next)++);
+    return now_ns() - t0;
+}
+
+static int compare(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double *v, int n)
+{
+    qsort(v, n, sizeof(*v), compare);
+    return v[n / 2];
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-r repeats] [-o results.json] [-t label] [kernel ...]\n", name);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    int repeats = BENCH_REPEATS;
+    const char *json = NULL;
+    const char *label = "";
+    double ns[BENCH_REPEATS * 4], dev[BENCH_REPEATS * 4], med, mad, cycles, bytes;
+    unsigned long n, next;
+    unsigned long long c0;
+    unsigned long b0;
+    FILE *out = NULL;
+    unsigned k;
+    int opt, r, a;
+
+    while ((opt = getopt(argc, argv, "r:o:t:")) != -1) {
+        switch (opt) {
+        case 'r': repeats = atoi(optarg); break;
+        case 'o': json = optarg; break;
+        case 't': label = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+    if ((repeats < 3) || (repeats > BENCH_REPEATS * 4)) usage(argv[0]);
+    if ((json != NULL) && ((out = fopen(json, "w")) == NULL)) {
+        perror(json);
+        return 1;
+    }
+
+    vpanel_reset();
+    firmware_main();    // screen set up; the threads are not run, kernels are called directly
+    printf("%-16s %10s %8s %6s %12s %10s\n", "kernel", "ns/call", "mad", "calls", "C28x cycles", "SPI bytes");
+    for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        for (a = optind; a < argc; a++) {
+            if (strcmp(argv[a], kernels[k].name) == 0) break;
+        }
+        if ((optind < argc) && (a == argc)) continue;
+
+        // size the batch, warm up, then time the batches
+        next = 0;
+        for (n = 1; (n < (1UL << 24)) && (batch_ns(&kernels[k], n, &next) < BENCH_BATCH_NS / 4); n *= 2) {
+        }
+        n *= 4;
+        batch_ns(&kernels[k], n, &next);
+        for (r = 0; r < repeats; r++) ns[r] = batch_ns(&kernels[k], n, &next) / n;
+        med = median(ns, repeats);
+        for (r = 0; r < repeats; r++) dev[r] = (ns[r] > med) ? ns[r] - med : med - ns[r];
+        mad = median(dev, repeats);
+
+        // modeled target cost of one more batch
+        c0 = bios_host_cycles;
+        b0 = vpanel_stats.bytes;
+        batch_ns(&kernels[k], n, &next);
+        cycles = (double)(bios_host_cycles - c0) / n;
+        bytes = (double)(vpanel_stats.bytes - b0) / n;
+
+        printf("%-16s %10.1f %8.1f %6lu %12.1f %10.2f\n", kernels[k].name, med, mad, n, cycles, bytes);
+        if (out != NULL) {
+            fprintf(out, "{\"label\": \"%s\", \"kernel\": \"%s\", \"ns_median\": %.2f, \"ns_mad\": %.2f, "
+                    "\"repeats\": %d, \"calls\": %lu, \"c28x_cycles\": %.1f, \"spi_bytes\": %.2f}\n",
+                    label, kernels[k].name, med, mad, repeats, n, cycles, bytes);
+        }
+    }
+    if (out != NULL) fclose(out);
+    return 0;
+}
@@ -0,0 +1,583 @@
+// bios_host.c
+// Author: Joseph Dobrzanski
+// Virtual-time scheduler behind the SYS/BIOS headers in host/include.
+
+#include <stdlib.h>
+#include <ucontext.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/utils/Load.h>
+#include <xdc/runtime/Timestamp.h>
+#include "bios_host.h"
+#include "cost.h"
+
+// 60 MHz SYSCLKOUT, SPI at LSPCLK / (SPI_BRR + 1) = 500 kHz
+// (the Swi cost leaves out what coord_project() charges with HAL_COST())
+struct bios_host_costs bios_host_costs = { 120, 610, 90, 150, 60, 960, 4, 45, 24, 3, 18 };
+unsigned long long bios_host_cycles = 0;
+unsigned long long bios_host_idle_cycles = 0;
+unsigned long bios_host_jitter = 0;
+
+// one event waiting for its time: an interrupt, or a device changing state (SCI byte arriving)
+struct event {
+    unsigned long long time;
+    unsigned long seq;      // keeps events with the same time in order
+    Hwi_Handle hwi;
+    void (*device)(UArg arg);
+    UArg arg;
+};
+
+static struct event events[BIOS_HOST_EVENTS];  // binary heap on (time, seq)
+static Int num_events = 0;
+static unsigned long event_seq = 0;
+
+static ucontext_t sched_context;
+static Task_Handle current = NULL;  // task on the CPU (also while it is interrupted)
+static Hwi_Handle hwi_active = NULL;
+static Swi_Handle swi_active = NULL;
+static Bool in_task = FALSE;        // CPU is in "current", not in the scheduler, idle or main()
+static Bool switching = FALSE;      // scheduler is switching to "current"
+static Task_Handle last_task = NULL; // task the switch hook was last called for (NULL = idle)
+static Bool started = FALSE;        // BIOS_start() was called (time before it belongs to main())
+static UInt hwi_masked = 0;         // Hwi_disable() is in effect
+static long tail_order = 0;         // ready queue order of the next task made ready
+static long head_order = 0;         // order of the next preempted task (front of its queue)
+static unsigned long random_state = 0;
+
+static unsigned long long start_time = 0;
+static unsigned long long load_start = 0;
+static unsigned long long load_idle = 0;
+static UInt32 load_percent = 0;
+
+static void preempt_check(void);
+static void run_swis(void);
+
+void bios_host_seed(unsigned long seed)
+{
+    random_state = seed;
+}
+
+// xorshift, 0 when no seed is set
+static unsigned long random_below(unsigned long limit)
+{
+    if ((random_state == 0) || (limit == 0)) return 0;
+    random_state ^= (random_state << 13) & 0xFFFFFFFFUL;
+    random_state ^= random_state >> 17;
+    random_state ^= (random_state << 5) & 0xFFFFFFFFUL;
+    return random_state % limit;
+}
+
+static void stats_latency(struct bios_host_stats *stats, unsigned long long cycles)
+{
+    unsigned long long us = cycles * 1000000ULL / BIOS_HOST_CPU_HZ;
+    Int bucket = 0;
+
+    while ((bucket < BIOS_HOST_BUCKETS - 1) && (us >= (1ULL << bucket))) bucket++;
+    stats->latency[bucket]++;
+    if (cycles > stats->latency_max) stats->latency_max = cycles;
+}
+
+static void stats_response(struct bios_host_stats *stats, unsigned long long cycles)
+{
+    if (cycles > stats->response_max) stats->response_max = cycles;
+    if ((stats->deadline != 0) && (cycles > stats->deadline)) stats->missed++;
+}
+
+//
+// event queue
+//
+
+static Bool event_before(const struct event *a, const struct event *b)
+{
+    return (a->time < b->time) || ((a->time == b->time) && (a->seq < b->seq));
+}
+
+static void event_add(struct event *ev)
+{
+    Int i, parent;
+
+    if (num_events == BIOS_HOST_EVENTS) {
+        fprintf(stderr, "bios_host: more than %d events pending\n", BIOS_HOST_EVENTS);
+        exit(1);
+    }
+    ev->time += random_below(bios_host_jitter + 1);
+    ev->seq = event_seq++;
+    i = num_events++;
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!event_before(ev, &events[parent])) break;
+        events[i] = events[parent];
+        i = parent;
+    }
+    events[i] = *ev;
+}
+
+static void event_pop(void)
+{
+    struct event last = events[--num_events];
+    Int i = 0, child;
+
+    while ((child = 2 * i + 1) < num_events) {
+        if ((child + 1 < num_events) && event_before(&events[child + 1], &events[child])) child++;
+        if (!event_before(&events[child], &last)) break;
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+}
+
+void bios_host_raise(unsigned long long time, Hwi_Handle hwi)
+{
+    struct event ev = { time, 0, hwi, NULL, 0 };
+    event_add(&ev);
+}
+
+void bios_host_device(unsigned long long time, void (*fxn)(UArg arg), UArg arg)
+{
+    struct event ev = { time, 0, NULL, fxn, arg };
+    event_add(&ev);
+}
+
+//
+// threads
+//
+
+static void run_hwi(Hwi_Handle hwi, unsigned long long raised)
+{
+    hwi_active = hwi;
+    hwi->stats.runs++;
+    stats_latency(&hwi->stats, bios_host_cycles - raised);
+    bios_host_hooks.hwi_begin(hwi);
+    bios_host_charge(bios_host_costs.hwi);
+    hwi->fxn();
+    bios_host_hooks.hwi_end(hwi);
+    stats_response(&hwi->stats, bios_host_cycles - raised);
+    hwi_active = NULL;
+}
+
+// deliver the events that are due; an interrupt waits while another Hwi runs
+static void deliver_events(void)
+{
+    struct event ev;
+
+    while ((num_events > 0) && (events[0].time <= bios_host_cycles)) {
+        ev = events[0];
+        if ((ev.hwi != NULL) && ((hwi_active != NULL) || hwi_masked)) return;
+        event_pop();
+        if (ev.hwi != NULL) {
+            run_hwi(ev.hwi, ev.time);
+            run_swis();
+            preempt_check();
+        } else {
+            ev.device(ev.arg);
+        }
+    }
+}
+
+// whoever is on the CPU uses "cycles"; events that fall due in between are delivered on time
+// (a task preempted in here gets the rest of its cycles when it runs again)
+void bios_host_charge(unsigned long cycles)
+{
+    unsigned long long left = cycles;
+    unsigned long long step;
+
+    while (left > 0) {
+        step = left;
+        if ((num_events > 0) && (events[0].time > bios_host_cycles) && (events[0].time - bios_host_cycles < left)) {
+            step = events[0].time - bios_host_cycles;
+        }
+        if (hwi_active != NULL) {
+            hwi_active->stats.cycles += step;
+        } else if (swi_active != NULL) {
+            swi_active->stats.cycles += step;
+        } else if (in_task || switching) {
+            current->stats.cycles += step;
+        } else if (started) {
+            bios_host_idle_cycles += step;
+            load_idle += step;
+        }
+        bios_host_cycles += step;
+        left -= step;
+        if (bios_host_cycles - load_start >= (unsigned long long)BIOS_HOST_CPU_HZ / 1000 * BIOS_HOST_LOAD_MS) {
+            load_percent = (UInt32)(100 - load_idle * 100 / (bios_host_cycles - load_start));
+            load_start = bios_host_cycles;
+            load_idle = 0;
+        }
+        deliver_events();
+    }
+    deliver_events();
+}
+
+// run posted Swis by priority, unless an Hwi or Swi is already running
+static void run_swis(void)
+{
+    Swi_Handle swi;
+    unsigned long first;
+    Int i;
+
+    if ((hwi_active != NULL) || (swi_active != NULL)) return;
+    for (;;) {
+        swi = NULL;
+        for (i = 0; i < bios_host_num_swis; i++) {
+            if (bios_host_swis[i]->posted && ((swi == NULL) || (bios_host_swis[i]->priority > swi->priority))) {
+                swi = bios_host_swis[i];
+            }
+        }
+        if (swi == NULL) return;
+        swi->posted = FALSE;
+        swi_active = swi;
+        swi->stats.runs++;
+        stats_latency(&swi->stats, bios_host_cycles - swi->posted_at);
+        bios_host_hooks.swi_begin(swi);
+        // an Hwi can come in before or after the Swi function reads the shared state
+        first = random_state ? random_below(bios_host_costs.swi + 1) : bios_host_costs.swi;
+        bios_host_charge(first);
+        swi->fxn(swi->arg);
+        bios_host_charge(bios_host_costs.swi - first);
+        bios_host_hooks.swi_end(swi);
+        stats_response(&swi->stats, bios_host_cycles - swi->posted_at);
+        swi_active = NULL;
+    }
+}
+
+UInt Hwi_disable(Void)
+{
+    UInt key = hwi_masked;
+    hwi_masked = 1;
+    return key;
+}
+
+Void Hwi_restore(UInt key)
+{
+    hwi_masked = key;
+    if (!hwi_masked) deliver_events(); // interrupts raised in between come in now
+}
+
+Void Swi_post(Swi_Handle swi)
+{
+    if (swi->posted) {
+        swi->merged++;
+    } else {
+        swi->posted = TRUE;
+        swi->posted_at = bios_host_cycles;
+    }
+    run_swis();
+    preempt_check();
+}
+
+static void task_entry(void)
+{
+    current->fxn();
+    current->mode = Task_Mode_TERMINATED;
+}
+
+Void BIOS_start(Void)
+{
+    Int i;
+    Task_Handle task;
+    ucontext_t *context;
+
+    for (i = 0; i < bios_host_num_tasks; i++) {
+        task = bios_host_tasks[i];
+        context = malloc(sizeof(ucontext_t));
+        if ((context == NULL) || (getcontext(context) != 0)) {
+            perror("BIOS_start");
+            exit(1);
+        }
+        context->uc_stack.ss_sp = malloc(BIOS_HOST_STACK);
+        context->uc_stack.ss_size = BIOS_HOST_STACK;
+        context->uc_link = &sched_context;
+        if (context->uc_stack.ss_sp == NULL) {
+            perror("BIOS_start");
+            exit(1);
+        }
+        makecontext(context, task_entry, 0);
+        task->context = context;
+        task->mode = Task_Mode_READY;
+        task->pending = NULL;
+        task->order = ++tail_order;
+    }
+    start_time = bios_host_cycles;
+    load_start = bios_host_cycles;
+    started = TRUE;
+}
+
+// highest priority ready task, first in its queue
+static Task_Handle next_ready(void)
+{
+    Task_Handle best = NULL;
+    Int i;
+
+    for (i = 0; i < bios_host_num_tasks; i++) {
+        Task_Handle task = bios_host_tasks[i];
+        if (task->mode != Task_Mode_READY) continue;
+        if ((best == NULL) || (task->priority > best->priority)
+            || ((task->priority == best->priority) && (task->order < best->order))) {
+            best = task;
+        }
+    }
+    return best;
+}
+
+// give the CPU back to the scheduler (the task's mode says why)
+static void task_switch(void)
+{
+    Task_Handle self = current;
+
+    in_task = FALSE;
+    swapcontext((ucontext_t *)self->context, &sched_context);
+}
+
+// a task can only be preempted when no Hwi or Swi runs on top of it
+static void preempt_check(void)
+{
+    Task_Handle next;
+
+    if (!in_task || (hwi_active != NULL) || (swi_active != NULL)) return;
+    next = next_ready();
+    if ((next != NULL) && (next->priority > current->priority)) {
+        current->mode = Task_Mode_READY;
+        current->order = --head_order; // stays at the front of its priority's queue
+        task_switch();
+    }
+}
+
+// run tasks until all of them are blocked
+static void run_tasks(void)
+{
+    Task_Handle task;
+
+    while ((task = next_ready()) != NULL) {
+        current = task;
+        switching = TRUE;
+        bios_host_charge(bios_host_costs.task_switch);
+        switching = FALSE;
+        if (next_ready() != task) continue; // a higher priority task got ready during the switch
+        task->mode = Task_Mode_RUNNING;
+        if (task != last_task) bios_host_hooks.task_switch(last_task, task);
+        last_task = task;
+        in_task = TRUE;
+        swapcontext(&sched_context, (ucontext_t *)task->context);
+        in_task = FALSE;
+        current = NULL;
+    }
+}
+
+// run the system until virtual time "until": tasks when they are ready, otherwise
+// the idle function, and when that has nothing to do the time jumps to the next event
+void bios_host_run(unsigned long long until)
+{
+    unsigned long long next;
+    unsigned long runs;
+    Int i;
+
+    for (;;) {
+        run_tasks();
+        if (bios_host_cycles >= until) return;
+        runs = 0;
+        for (i = 0; i < bios_host_num_swis; i++) runs += bios_host_swis[i]->stats.runs;
+        if (last_task != NULL) bios_host_hooks.task_switch(last_task, NULL);
+        last_task = NULL;
+        bios_host_charge(bios_host_costs.idle);
+        bios_host_idle();
+        for (i = 0; i < bios_host_num_swis; i++) runs -= bios_host_swis[i]->stats.runs;
+        if ((runs != 0) || (next_ready() != NULL)) continue;
+        next = ((num_events > 0) && (events[0].time < until)) ? events[0].time : until;
+        if (next > bios_host_cycles) bios_host_charge((unsigned long)(next - bios_host_cycles));
+    }
+}
+
+//
+// Semaphore, Task, Timestamp and Load API
+//
+
+Bool Semaphore_pend(Semaphore_Handle sem, UInt timeout)
+{
+    Task_Handle self = current;
+    unsigned long long posted;
+
+    if (in_task && (sem == self->work) && self->in_job) {
+        stats_response(&self->stats, bios_host_cycles - self->release);
+        self->in_job = FALSE;
+    }
+    cost_charge(COST_SEMAPHORE, 1);
+    if (sem->count == 0) {
+        if (!in_task || (hwi_active != NULL) || (swi_active != NULL) || (timeout == BIOS_NO_WAIT)) {
+            return FALSE;
+        }
+        self->mode = Task_Mode_BLOCKED;
+        self->pending = sem;
+        self->pend_start = bios_host_cycles;
+        task_switch(); // the post hands the count over to this task
+        stats_latency(&sem->stats, bios_host_cycles - self->pend_start);
+    } else {
+        sem->count--;
+        if (in_task) stats_latency(&sem->stats, 0);
+    }
+    sem->stats.runs++;
+
+    posted = bios_host_cycles;
+    if (sem->post_count > 0) {
+        posted = sem->post_time[sem->post_head];
+        sem->post_head = (sem->post_head + 1) % SEMAPHORE_POST_TIMES;
+        sem->post_count--;
+    }
+    if (in_task && (sem == self->work)) {
+        self->stats.runs++;
+        stats_latency(&self->stats, bios_host_cycles - posted);
+        self->release = posted;
+        self->in_job = TRUE;
+    }
+    return TRUE;
+}
+
+Void Semaphore_post(Semaphore_Handle sem)
+{
+    Task_Handle waiter = NULL;
+    Int i;
+
+    cost_charge(COST_SEMAPHORE, 1);
+    if (sem->post_count < SEMAPHORE_POST_TIMES) {
+        sem->post_time[(sem->post_head + sem->post_count) % SEMAPHORE_POST_TIMES] = bios_host_cycles;
+        sem->post_count++;
+    }
+    for (i = 0; i < bios_host_num_tasks; i++) {
+        Task_Handle task = bios_host_tasks[i];
+        if ((task->mode != Task_Mode_BLOCKED) || (task->pending != sem)) continue;
+        if ((waiter == NULL) || (task->priority > waiter->priority)
+            || ((task->priority == waiter->priority) && (task->order < waiter->order))) {
+            waiter = task;
+        }
+    }
+    if (waiter == NULL) {
+        if (sem->mode == Semaphore_Mode_BINARY) {
+            if (sem->count == 1) sem->post_count--; // no one will take this post
+            sem->count = 1;
+        } else {
+            sem->count++;
+        }
+        return;
+    }
+
+    waiter->mode = Task_Mode_READY;
+    waiter->pending = NULL;
+    waiter->order = ++tail_order;
+    preempt_check();
+}
+
+Int Semaphore_getCount(Semaphore_Handle sem)
+{
+    return sem->count;
+}
+
+Void Task_yield(Void)
+{
+    if (!in_task || (hwi_active != NULL) || (swi_active != NULL)) return;
+    current->mode = Task_Mode_READY;
+    current->order = ++tail_order;
+    task_switch();
+}
+
+Task_Handle Task_self(Void)
+{
+    return current;
+}
+
+Bits32 Timestamp_get32(void)
+{
+    return (Bits32)bios_host_cycles;
+}
+
+void Timestamp_getFreq(Types_FreqHz *freq)
+{
+    freq->hi = 0;
+    freq->lo = BIOS_HOST_CPU_HZ;
+}
+
+// percentage of the last Load window the CPU was not idle
+UInt32 Load_getCPULoad(Void)
+{
+    return load_percent;
+}
+
+//
+// report
+//
+
+static double us(unsigned long long cycles)
+{
+    return cycles * 1e6 / BIOS_HOST_CPU_HZ;
+}
+
+// upper bound of the bucket holding the p-th percentile, in us
+static unsigned long percentile(const struct bios_host_stats *stats, Int p)
+{
+    unsigned long total = 0, seen = 0;
+    Int i;
+
+    for (i = 0; i < BIOS_HOST_BUCKETS; i++) total += stats->latency[i];
+    for (i = 0; i < BIOS_HOST_BUCKETS; i++) {
+        seen += stats->latency[i];
+        if (seen * 100 >= total * p) return 1UL << i;
+    }
+    return 1UL << (BIOS_HOST_BUCKETS - 1);
+}
+
+static void report_line(FILE *out, const char *kind, const char *name, const struct bios_host_stats *stats)
+{
+    unsigned long long elapsed = bios_host_cycles ? bios_host_cycles : 1;
+    Int i;
+
+    fprintf(out, "%-4s %-13s %8lu %6.2f%% %7lu %7lu %9.1f %9.1f", kind, name, stats->runs,
+            stats->cycles * 100.0 / elapsed, percentile(stats, 50), percentile(stats, 99),
+            us(stats->latency_max), us(stats->response_max));
+    if (stats->deadline != 0) {
+        fprintf(out, " %9.1f %6lu", us(stats->deadline), stats->missed);
+    }
+    fprintf(out, "\n     latency us <1");
+    for (i = 1; i < BIOS_HOST_BUCKETS; i++) fprintf(out, " <%lu", 1UL << i);
+    fprintf(out, "+\n     ");
+    for (i = 0; i < BIOS_HOST_BUCKETS; i++) fprintf(out, " %lu", stats->latency[i]);
+    fprintf(out, "\n");
+}
+
+// name and statistics of the thread on the CPU (idle and main() have no statistics)
+const char *bios_host_thread(struct bios_host_stats **stats)
+{
+    *stats = NULL;
+    if (hwi_active != NULL) {
+        *stats = &hwi_active->stats;
+        return hwi_active->name;
+    }
+    if (swi_active != NULL) {
+        *stats = &swi_active->stats;
+        return swi_active->name;
+    }
+    if (in_task || switching) {
+        *stats = &current->stats;
+        return current->name;
+    }
+    return started ? "idle" : "main";
+}
+
+void bios_host_report(FILE *out)
+{
+    Int i;
+
+    fprintf(out, "virtual time   %.3f ms, idle %.1f%% since BIOS_start()\n", us(bios_host_cycles) / 1000,
+            bios_host_idle_cycles * 100.0 / ((bios_host_cycles > start_time) ? bios_host_cycles - start_time : 1));
+    fprintf(out, "                        runs    cpu  p50 us  p99 us    max us  resp max  deadline missed\n");
+    for (i = 0; i < bios_host_num_hwis; i++) {
+        report_line(out, "hwi", bios_host_hwis[i]->name, &bios_host_hwis[i]->stats);
+    }
+    for (i = 0; i < bios_host_num_swis; i++) {
+        report_line(out, "swi", bios_host_swis[i]->name, &bios_host_swis[i]->stats);
+        fprintf(out, "     posts merged into a pending run: %lu\n", bios_host_swis[i]->merged);
+    }
+    for (i = 0; i < bios_host_num_tasks; i++) {
+        report_line(out, "task", bios_host_tasks[i]->name, &bios_host_tasks[i]->stats);
+    }
+    // time spent blocked on each semaphore
+    for (i = 0; i < bios_host_num_semaphores; i++) {
+        report_line(out, "sem", bios_host_semaphores[i]->name, &bios_host_semaphores[i]->stats);
+    }
+}
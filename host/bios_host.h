@@ -0,0 +1,79 @@
+// bios_host.h
+// Author: Joseph Dobrzanski
+// Virtual-time SYS/BIOS emulator for the host build. The static objects of
+// main_file.cfg are in sim_cfg.c.
+//
+// Time only moves when a thread is charged for an operation (bios_host_charge(),
+// with the costs in bios_host_costs) or when the CPU is idle. Events scheduled
+// with bios_host_raise()/bios_host_device() are delivered at their exact time
+// inside a charge, so an Hwi can land in the middle of a task's SPI transfer
+// and the tasks are preempted by priority like on the target. Hwis do not nest,
+// a posted Swi runs when the last Hwi returns, and tasks only run when no Hwi
+// or Swi is active. With a seed set, event times get random jitter and the Swi
+// is interrupted at a random point, to shake out races between the threads.
+
+#ifndef BIOS_HOST_H
+#define BIOS_HOST_H
+
+#include <stdio.h>
+#include <xdc/std.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Swi.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#define BIOS_HOST_CPU_HZ    60000000UL  // SYSCLKOUT, Timestamp frequency
+#define BIOS_HOST_STACK     (64 * 1024) // host stack per task
+#define BIOS_HOST_EVENTS    1024        // events waiting to be delivered
+#define BIOS_HOST_LOAD_MS   500         // Load module window
+
+// cost of each operation in CPU cycles
+struct bios_host_costs {
+    unsigned long hwi;          // interrupt entry and exit (plus the Hwi function)
+    unsigned long swi;          // Swi dispatch plus the Swi function
+    unsigned long semaphore;    // one Semaphore_post() or Semaphore_pend()
+    unsigned long task_switch;  // context switch
+    unsigned long idle;         // one pass of the idle loop
+    unsigned long spi_byte;     // spi_send() waits for the byte to leave (8 bits at 500 kHz)
+    unsigned long delay_tick;   // one iteration of delay_loop()
+    unsigned long div32;        // 32-bit division or modulo, run-time library (cost.h)
+    unsigned long div16;        // 16-bit division or modulo, run-time library
+    unsigned long mul32;        // 32 x 32 bit multiply
+    unsigned long owner;        // one bin of the owner scan: loop step, call and return (render.c)
+};
+
+// hook sets of main_file.cfg (Hwi/Swi begin and end, task switch); a NULL task is the idle loop
+struct bios_host_hooks {
+    Void (*hwi_begin)(Hwi_Handle hwi);
+    Void (*hwi_end)(Hwi_Handle hwi);
+    Void (*swi_begin)(Swi_Handle swi);
+    Void (*swi_end)(Swi_Handle swi);
+    Void (*task_switch)(Task_Handle prev, Task_Handle next);
+};
+
+// static configuration (sim_cfg.c)
+extern Hwi_Handle const bios_host_hwis[];
+extern const Int bios_host_num_hwis;
+extern Swi_Handle const bios_host_swis[];
+extern const Int bios_host_num_swis;
+extern Task_Handle const bios_host_tasks[];
+extern const Int bios_host_num_tasks;
+extern Semaphore_Handle const bios_host_semaphores[];
+extern const Int bios_host_num_semaphores;
+extern Void (*const bios_host_idle)(Void);
+extern const struct bios_host_hooks bios_host_hooks;
+
+extern struct bios_host_costs bios_host_costs;
+extern unsigned long long bios_host_cycles;     // virtual time
+extern unsigned long long bios_host_idle_cycles; // time spent idle
+extern unsigned long bios_host_jitter;          // events are delayed by up to this many cycles (with a seed set)
+
+void bios_host_seed(unsigned long seed);
+void bios_host_charge(unsigned long cycles);
+void bios_host_raise(unsigned long long time, Hwi_Handle hwi);
+void bios_host_device(unsigned long long time, void (*fxn)(UArg arg), UArg arg);
+void bios_host_run(unsigned long long until);
+void bios_host_report(FILE *out);
+const char *bios_host_thread(struct bios_host_stats **stats);
+
+#endif
@@ -0,0 +1,20 @@
+// bios_host_stats.h
+// Author: Joseph Dobrzanski
+// Timing statistics kept by bios_host.c for every Hwi, Swi, task and semaphore.
+
+#ifndef BIOS_HOST_STATS_H
+#define BIOS_HOST_STATS_H
+
+#define BIOS_HOST_BUCKETS   16      // latency histogram: [0] < 1 us, [i] < 2^i us, [15] everything longer
+
+struct bios_host_stats {
+    unsigned long runs;                 // times the thread ran (Hwi, Swi) or got the semaphore (task)
+    unsigned long long cycles;          // CPU time used
+    unsigned long latency[BIOS_HOST_BUCKETS]; // ready (posted, interrupt raised) to running
+    unsigned long long latency_max;
+    unsigned long long response_max;    // ready to done
+    unsigned long long deadline;        // response time allowed, 0 = none
+    unsigned long missed;               // responses over the deadline
+};
+
+#endif
@@ -0,0 +1,164 @@
+// coord_check.c
+// Author: Joseph Dobrzanski
+// Accuracy of the coordinate conversion backends (coord.c). Every encoder bin,
+// every raw distance and every zoom level is converted and compared with the
+// exact point, dist * (cos, sin) from the same whole-pixel distance, so only
+// the error of the conversion is measured, not the rounding of the distance.
+// Reports the max, mean and RMS distance to the exact point, the share of
+// points that land on another pixel than the rounded exact one, the worst
+// cases, and the worst error near the quadrant boundaries (where the
+// approximation switches formulas). A backend passes if it stays inside the
+// budget in coord.h (COORD_BUDGET_MAX, COORD_BUDGET_RMS); the exit status is
+// the number of backends over it.
+//
+//   coord_check [-w worst] [backend ...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "hal.h"
+#include "main_file.h"
+#include "coord.h"
+#include "spi_screen.h"
+
+#define WORST_MAX       32
+#define BOUNDARY_BINS   3       // bins on each side of 0, 90, 180 and 270 degrees
+
+struct backend {
+    const char *name;
+    void (*project)(int16 distance, int32 angle, Uint16 scale, int16 *x, int16 *y);
+};
+
+struct worst {
+    double error;
+    int16 bin, distance, level;
+    int16 x, y;
+    double ex, ey;
+};
+
+static const struct backend backends[] = {
+    { "approx", coord_project },
+    { "table", coord_project_table },
+    { "cordic", coord_project_cordic },
+};
+
+// within BOUNDARY_BINS of a quadrant boundary (bins 0, 56.25, 112.5 and 168.75)
+static int near_boundary(int16 bin)
+{
+    double edge;
+    int16 k;
+
+    for (k = 0; k <= 4; k++) {
+        edge = k * NUM_BINS / 4.0;
+        if (fabs(bin - edge) <= BOUNDARY_BINS) return 1;
+    }
+    return 0;
+}
+
+// keep the "max" largest errors, largest first
+static void keep_worst(struct worst *worst, int *num, int max, const struct worst *w)
+{
+    int i;
+
+    // many distances and zoom levels give the same pixel distance: list each point once
+    for (i = 0; i < *num; i++) {
+        if ((worst[i].bin == w->bin) && (worst[i].x == w->x) && (worst[i].y == w->y)) return;
+    }
+    if (max == 0) return;
+    if (*num < max) {
+        i = (*num)++;
+    } else if (w->error > worst[max - 1].error) {
+        i = max - 1;
+    } else {
+        return;
+    }
+    while ((i > 0) && (worst[i - 1].error < w->error)) {
+        worst[i] = worst[i - 1];
+        i--;
+    }
+    worst[i] = *w;
+}
+
+static int check(const struct backend *b, int show)
+{
+    struct worst worst[WORST_MAX], w;
+    int num_worst = 0;
+    double sum = 0, sum2 = 0, max = 0, boundary_max = 0, err, a;
+    unsigned long points = 0, off = 0, off2 = 0;
+    Uint32 dist;
+    int16 bin, distance, level, x, y, cx = _width / 2, cy = _height / 2;
+    int over, i;
+
+    for (level = 0; level < ZOOM_LEVELS; level++) {
+        for (bin = 0; bin < NUM_BINS; bin++) {
+            a = bin * ENCODER_ANG / (double)SF * M_PI / 180.0;
+            for (distance = 0; distance < 256; distance++) {
+                dist = ((Uint32)distance * zoom_scales[level] + 128) >> 8;
+                if (dist > COORD_MAX_PX) dist = COORD_MAX_PX;
+                b->project(distance, (int32)bin * ENCODER_ANG, zoom_scales[level], &x, &y);
+
+                w.ex = cx + dist * cos(a);
+                w.ey = cy + dist * sin(a);
+                err = hypot(x - w.ex, y - w.ey);
+                points++;
+                sum += err;
+                sum2 += err * err;
+                if (err > max) max = err;
+                if (near_boundary(bin) && (err > boundary_max)) boundary_max = err;
+                // landed on another pixel than the rounded exact point (by one, or by more)
+                if ((x != (int16)floor(w.ex + 0.5)) || (y != (int16)floor(w.ey + 0.5))) off++;
+                if ((abs(x - (int16)floor(w.ex + 0.5)) > 1) || (abs(y - (int16)floor(w.ey + 0.5)) > 1)) off2++;
+
+                w.error = err;
+                w.bin = bin;
+                w.distance = distance;
+                w.level = level;
+                w.x = x;
+                w.y = y;
+                keep_worst(worst, &num_worst, show, &w);
+            }
+        }
+    }
+    over = (max * 10 > COORD_BUDGET_MAX) || (sqrt(sum2 / points) * 10 > COORD_BUDGET_RMS);
+    printf("%-8s max %.3f  mean %.3f  rms %.3f  boundary max %.3f px, %.2f%% off by a pixel, %.3f%% by more: %s\n",
+           b->name, max, sum / points, sqrt(sum2 / points), boundary_max, off * 100.0 / points, off2 * 100.0 / points,
+           over ? "OVER BUDGET" : "within budget");
+    for (i = 0; i < num_worst; i++) {
+        printf("         bin %3d (%5.1f deg) distance %3d zoom %d: (%d, %d), exact (%.2f, %.2f), %.3f px\n",
+               worst[i].bin, worst[i].bin * ENCODER_ANG / (double)SF, worst[i].distance, worst[i].level,
+               worst[i].x, worst[i].y, worst[i].ex, worst[i].ey, worst[i].error);
+    }
+    return over;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-w worst] [backend ...]\n", name);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    int show = 5, failed = 0, opt, a;
+    unsigned i;
+
+    while ((opt = getopt(argc, argv, "w:")) != -1) {
+        switch (opt) {
+        case 'w': show = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if ((show < 0) || (show > WORST_MAX)) usage(argv[0]);
+
+    printf("budget   max %.1f px, rms %.1f px (coord.h)\n", COORD_BUDGET_MAX / 10.0, COORD_BUDGET_RMS / 10.0);
+    for (i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        for (a = optind; a < argc; a++) {
+            if (strcmp(argv[a], backends[i].name) == 0) break;
+        }
+        if ((optind < argc) && (a == argc)) continue;
+        failed += check(&backends[i], show);
+    }
+    return failed;
+}
@@ -0,0 +1,125 @@
+// cost.c
+// Author: Joseph Dobrzanski
+// Per-thread tally of the modeled operations (cost.h). The total time of each
+// thread comes from bios_host.c; what the tally does not explain is reported
+// as "other" (dispatch and the code between the modeled operations, which is
+// in the flat hwi, swi and task_switch costs).
+
+#include <string.h>
+#include "bios_host.h"
+#include "cost.h"
+
+struct cost_thread {
+    const char *name;
+    const struct bios_host_stats *stats;    // NULL for idle and main()
+    unsigned long long base;                // thread cycles at cost_reset()
+    unsigned long long count[COST_OPS];
+    unsigned long long cycles[COST_OPS];
+};
+
+static const char *const op_names[COST_OPS] = { "spi_byte", "delay_tick", "semaphore", "div32", "div16", "mul32", "owner_scan", "code" };
+
+static struct cost_thread threads[COST_THREADS];
+static int num_threads = 0;
+static unsigned long long reset_time = 0;
+
+static unsigned long op_cycles(int op)
+{
+    switch (op) {
+    case COST_SPI_BYTE: return bios_host_costs.spi_byte;
+    case COST_DELAY_TICK: return bios_host_costs.delay_tick;
+    case COST_SEMAPHORE: return bios_host_costs.semaphore;
+    case COST_DIV32: return bios_host_costs.div32;
+    case COST_DIV16: return bios_host_costs.div16;
+    case COST_MUL32: return bios_host_costs.mul32;
+    case COST_OWNER: return bios_host_costs.owner;
+    default: return 1;
+    }
+}
+
+static struct cost_thread *thread(const char *name, const struct bios_host_stats *stats)
+{
+    int i;
+
+    for (i = 0; i < num_threads; i++) {
+        if ((threads[i].name == name) || (strcmp(threads[i].name, name) == 0)) return &threads[i];
+    }
+    if (num_threads == COST_THREADS) return NULL;
+    threads[num_threads].name = name;
+    threads[num_threads].stats = stats;
+    threads[num_threads].base = stats ? stats->cycles : 0;
+    return &threads[num_threads++];
+}
+
+// the running thread does "n" operations "op"
+void cost_charge(int op, unsigned long n)
+{
+    struct bios_host_stats *stats;
+    const char *name = bios_host_thread(&stats);
+    struct cost_thread *t = thread(name, stats);
+    unsigned long cycles = n * op_cycles(op);
+
+    if (t != NULL) {
+        t->count[op] += n;
+        t->cycles[op] += cycles;
+    }
+    bios_host_charge(cycles);
+}
+
+// start a new budget: forget the tally, every thread starts from its current time
+void cost_reset(void)
+{
+    Int i;
+
+    memset(threads, 0, sizeof(threads));
+    num_threads = 0;
+    for (i = 0; i < bios_host_num_hwis; i++) thread(bios_host_hwis[i]->name, &bios_host_hwis[i]->stats);
+    for (i = 0; i < bios_host_num_swis; i++) thread(bios_host_swis[i]->name, &bios_host_swis[i]->stats);
+    for (i = 0; i < bios_host_num_tasks; i++) thread(bios_host_tasks[i]->name, &bios_host_tasks[i]->stats);
+    thread("idle", NULL)->base = bios_host_idle_cycles;
+    reset_time = bios_host_cycles;
+}
+
+static void report_line(FILE *out, const char *name, const char *op, double count, double cycles, double sweep)
+{
+    fprintf(out, "  %-16s %-11s", name, op);
+    if (count >= 0) {
+        fprintf(out, " %11.1f", count);
+    } else {
+        fprintf(out, " %11s", "");
+    }
+    fprintf(out, " %12.0f %9.3f %6.2f%%\n", cycles, cycles * 1e3 / BIOS_HOST_CPU_HZ, cycles * 100.0 / sweep);
+}
+
+// modeled budget of every thread per sweep since cost_reset(); the SPI wire time of a
+// thread is the time its bytes took at 500 kHz (spi_byte is charged while waiting for it)
+void cost_report(FILE *out, double sweeps)
+{
+    unsigned long long elapsed = bios_host_cycles - reset_time;
+    double sweep = (sweeps > 0) ? elapsed / sweeps : (double)elapsed;
+    double total, rest, busy = 0;
+    int i, op;
+
+    if (sweep <= 0) return;
+    fprintf(out, "modeled budget per sweep (%.3f ms, %.0f cycles)\n", sweep * 1e3 / BIOS_HOST_CPU_HZ, sweep);
+    fprintf(out, "  thread           operation    count/sweep cycles/sweep  ms/sweep  sweep\n");
+    for (i = 0; i < num_threads; i++) {
+        struct cost_thread *t = &threads[i];
+
+        total = ((t->stats ? t->stats->cycles : bios_host_idle_cycles) - t->base) / sweeps;
+        if (t->stats != NULL) busy += total;
+        report_line(out, t->name, "total", -1, total, sweep);
+        rest = total;
+        for (op = 0; op < COST_OPS; op++) {
+            if (t->count[op] == 0) continue;
+            report_line(out, "", op_names[op], t->count[op] / sweeps, t->cycles[op] / sweeps, sweep);
+            rest -= t->cycles[op] / sweeps;
+        }
+        if ((t->stats != NULL) && (rest != total)) report_line(out, "", "other", -1, rest, sweep);
+        if (t->count[COST_SPI_BYTE] > 0) {
+            fprintf(out, "  %-16s %-11s %11s %12s %9.3f\n", "", "spi wire", "", "",
+                    t->count[COST_SPI_BYTE] * 16.0 / 1000 / sweeps);
+        }
+    }
+    fprintf(out, "predicted CPU load %.1f%%\n", busy * 100.0 / sweep);
+}
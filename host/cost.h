@@ -0,0 +1,34 @@
+// cost.h
+// Author: Joseph Dobrzanski
+// Modeled C28x cost of the hot operations in the host build. SPI bytes,
+// delay_loop() iterations and semaphore operations are charged here by the
+// host HAL and bios_host.c; the arithmetic the C28x has no single instruction
+// for (32-bit division, run-time library calls) is charged by HAL_COST() in
+// the application code, which is empty on the target, and so are the loops of
+// the rendering (render.c, layers.c, contour.c, sweep_line.c, sweep_history.c,
+// hud.c), per iteration. Everything is tallied per thread, so cost_report()
+// can print a budget per sweep.
+
+#ifndef COST_H
+#define COST_H
+
+#include <stdio.h>
+
+// operations, their cycles are in bios_host_costs
+#define COST_SPI_BYTE   0   // spi_send() waiting for the byte to leave
+#define COST_DELAY_TICK 1   // one delay_loop() iteration
+#define COST_SEMAPHORE  2   // Semaphore_post() or Semaphore_pend()
+#define COST_DIV32      3   // 32-bit division or modulo (RTS call)
+#define COST_DIV16      4   // 16-bit division or modulo (RTS call)
+#define COST_MUL32      5   // 32 x 32 bit multiply
+#define COST_OWNER      6   // one bin looked at by an owner scan (render.c)
+#define COST_CYCLES     7   // straight-line code, cycles counted by hand
+#define COST_OPS        8
+
+#define COST_THREADS    16
+
+void cost_charge(int op, unsigned long n);
+void cost_reset(void);
+void cost_report(FILE *out, double sweeps);
+
+#endif
@@ -0,0 +1,105 @@
+// ctrace.c
+// Author: Joseph Dobrzanski
+// Converts an event trace dump (evtrace.h, "LEV1") into the Chrome trace event
+// format, for chrome://tracing or ui.perfetto.dev. Each thread of the firmware
+// is a row: Hwis and the Swi are begin/end slices, a task's slice runs from the
+// switch to it up to the next switch away from it.
+//
+//   ctrace events.bin > events.json
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "evtrace.h"
+
+static const char *const names[EVTRACE_THREADS] = {
+    "Idle", "encoder_Fxn (hwi0)", "IR_Fxn (hwi1)", "polar_to_cart_Fxn (mySwi)",
+    "draw_point", "clear_point", "redraw_point", "other"
+};
+
+static int open_slices[EVTRACE_THREADS];    // begins not ended yet, per thread
+static int first = 1;
+
+static unsigned long u32(const unsigned char *p)
+{
+    return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) | ((unsigned long)p[2] << 8) | p[3];
+}
+
+static void event(char phase, int thread, double us)
+{
+    if (phase == 'E') {
+        if (open_slices[thread] == 0) return; // began before the oldest record
+        open_slices[thread]--;
+    } else {
+        open_slices[thread]++;
+    }
+    printf("%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+           first ? "" : ",", names[thread], phase, thread, us);
+    first = 0;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in;
+    unsigned char header[EVTRACE_HEADER], r[EVTRACE_RECORD_BYTES];
+    unsigned long freq, count, n, prev = 0;
+    unsigned long long time = 0;
+    double us = 0;
+    int thread, task = -1, i;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s events.bin > events.json\n", argv[0]);
+        return 2;
+    }
+    in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    if ((fread(header, 1, EVTRACE_HEADER, in) != EVTRACE_HEADER) || (memcmp(header, "LEV1", 4) != 0)) {
+        fprintf(stderr, "%s: not an event trace dump\n", argv[1]);
+        return 1;
+    }
+    freq = u32(&header[4]);
+    count = ((unsigned long)header[8] << 8) | header[9];
+    if (freq == 0) {
+        fprintf(stderr, "%s: no Timestamp frequency\n", argv[1]);
+        return 1;
+    }
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (i = 0; i < EVTRACE_THREADS; i++) {
+        printf("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+               first ? "" : ",", i, names[i]);
+        printf(",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}", i, i);
+        first = 0;
+    }
+    for (n = 0; n < count; n++) {
+        if (fread(r, 1, EVTRACE_RECORD_BYTES, in) != EVTRACE_RECORD_BYTES) {
+            fprintf(stderr, "%s: truncated after %lu of %lu records\n", argv[1], n, count);
+            break;
+        }
+        // the Timestamp wraps; times are relative to the oldest record
+        if (n > 0) time += (u32(r) - prev) & 0xFFFFFFFFUL;
+        prev = u32(r);
+        us = time * 1e6 / freq;
+        thread = r[4] % EVTRACE_THREADS;
+        switch (r[5]) {
+        case EVTRACE_BEGIN: event('B', thread, us); break;
+        case EVTRACE_END: event('E', thread, us); break;
+        case EVTRACE_SWITCH:
+            if (task >= 0) event('E', task, us);
+            event('B', thread, us);
+            task = thread;
+            break;
+        }
+    }
+    // close what is still running at the last record
+    for (i = 0; i < EVTRACE_THREADS; i++) {
+        while (open_slices[i] > 0) event('E', i, us);
+    }
+    printf("\n]}\n");
+    fclose(in);
+    fprintf(stderr, "%lu records, %.3f ms\n", n, us / 1000);
+    return 0;
+}
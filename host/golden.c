@@ -0,0 +1,168 @@
+// golden.c
+// Author: Joseph Dobrzanski
+// Frame hashes and SPI traffic at the end of every sweep, compared with or
+// written to a manifest (golden.h). A frame that does not match is written
+// next to the manifest as <manifest>.<sweep>.ppm so it can be looked at.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+#include "spi_screen.h"
+#include "bios_host.h"
+#include "vpanel.h"
+#include "golden.h"
+
+struct golden_sweep {
+    unsigned long hash;
+    unsigned long bytes;
+    unsigned long commands;
+};
+
+static const char *manifest = NULL;        // checking against this manifest
+static struct golden_sweep expected[GOLDEN_SWEEPS];
+static int expected_sweeps = 0;
+static unsigned long expected_final = 0;
+static struct golden_sweep actual[GOLDEN_SWEEPS];
+static int actual_sweeps = 0;
+static unsigned long last_bytes, last_commands;
+static int failures = 0;
+
+int golden_load(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    char line[512];
+    struct golden_sweep s;
+    int n, found_final = 0;
+
+    if (in == NULL) {
+        perror(path);
+        return -1;
+    }
+    expected_sweeps = 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (sscanf(line, "sweep %d %lx %lu %lu", &n, &s.hash, &s.bytes, &s.commands) == 4) {
+            if ((n != expected_sweeps + 1) || (n > GOLDEN_SWEEPS)) break;
+            expected[expected_sweeps++] = s;
+        } else if (sscanf(line, "final %lx", &expected_final) == 1) {
+            found_final = 1;
+        }
+    }
+    fclose(in);
+    if (!found_final) {
+        fprintf(stderr, "%s: not a golden manifest\n", path);
+        return -1;
+    }
+    manifest = path;
+    return 0;
+}
+
+static void write_frame(const char *what)
+{
+    char name[512];
+    FILE *out;
+
+    snprintf(name, sizeof(name), "%s.%s.ppm", manifest, what);
+    out = fopen(name, "wb");
+    if (out == NULL) return;
+    vpanel_write_ppm(out, _width, _height);
+    fclose(out);
+    printf("golden         wrote %s\n", name);
+}
+
+// end of sweep "n" (1 = first): take the hash and the traffic, check them right away
+// when a manifest is loaded, so the frame that differs can still be written
+static void sweep_end(UArg n)
+{
+    struct golden_sweep *s;
+    char what[16];
+    int bad = 0;
+
+    if (n > GOLDEN_SWEEPS) return;
+    s = &actual[n - 1];
+    s->hash = vpanel_hash(_width, _height);
+    s->bytes = vpanel_stats.bytes - last_bytes;
+    s->commands = vpanel_stats.commands - last_commands;
+    last_bytes = vpanel_stats.bytes;
+    last_commands = vpanel_stats.commands;
+    actual_sweeps = n;
+    if ((manifest == NULL) || (n > expected_sweeps)) return;
+
+    if (s->hash != expected[n - 1].hash) {
+        printf("golden         sweep %d: frame %08lx, expected %08lx\n", (int)n, s->hash, expected[n - 1].hash);
+        snprintf(what, sizeof(what), "%d", (int)n);
+        write_frame(what);
+        bad = 1;
+    }
+    if ((s->bytes > expected[n - 1].bytes) || (s->commands > expected[n - 1].commands)) {
+        printf("golden         sweep %d: %lu bytes, %lu commands, at most %lu and %lu allowed\n", (int)n,
+               s->bytes, s->commands, expected[n - 1].bytes, expected[n - 1].commands);
+        bad = 1;
+    }
+    failures += bad;
+}
+
+// take a checkpoint at the end of each of "sweeps" sweeps of "period" cycles from "start"
+void golden_start(unsigned long long start, double period, int sweeps)
+{
+    int n;
+
+    last_bytes = vpanel_stats.bytes;
+    last_commands = vpanel_stats.commands;
+    actual_sweeps = 0;
+    failures = 0;
+    for (n = 1; (n <= sweeps) && (n <= GOLDEN_SWEEPS); n++) {
+        bios_host_device(start + (unsigned long long)(n * period), sweep_end, n);
+    }
+}
+
+// after the run: check the final frame and the number of sweeps, returns the number of failures
+// "wrong" pixels found by sim_check_screen(), SCI bytes "lost" to FIFO overruns
+int golden_finish(FILE *out, int wrong, unsigned long lost)
+{
+    unsigned long hash = vpanel_hash(_width, _height);
+
+    if (manifest == NULL) return 0;
+    if (wrong != 0) {
+        fprintf(out, "golden         %d wrong pixels\n", wrong);
+        failures++;
+    }
+    if (lost != 0) {
+        fprintf(out, "golden         %lu sci bytes lost\n", lost);
+        failures++;
+    }
+    if (actual_sweeps != expected_sweeps) {
+        fprintf(out, "golden         %d sweeps, manifest has %d\n", actual_sweeps, expected_sweeps);
+        failures++;
+    }
+    if (hash != expected_final) {
+        fprintf(out, "golden         final frame %08lx, expected %08lx\n", hash, expected_final);
+        write_frame("final");
+        failures++;
+    }
+    fprintf(out, "golden         %s: %s\n", manifest, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+// write what this run did as a new manifest, with the arguments that reproduce it
+int golden_write(const char *path, int argc, char **argv)
+{
+    FILE *out = fopen(path, "w");
+    int i;
+
+    if (out == NULL) {
+        perror(path);
+        return -1;
+    }
+    fprintf(out, "args");
+    for (i = 1; i < argc; i++) fprintf(out, " %s", argv[i]);
+    fprintf(out, "\n");
+    for (i = 0; i < actual_sweeps; i++) {
+        fprintf(out, "sweep %d %08lx %lu %lu\n", i + 1, actual[i].hash,
+                actual[i].bytes + actual[i].bytes * GOLDEN_SLACK / 100,
+                actual[i].commands + actual[i].commands * GOLDEN_SLACK / 100);
+    }
+    fprintf(out, "final %08lx\n", vpanel_hash(_width, _height));
+    fclose(out);
+    return 0;
+}
@@ -0,0 +1,27 @@
+// golden.h
+// Author: Joseph Dobrzanski
+// Golden-image regression checks for the host build. A manifest (golden/*.gold)
+// holds the simulator arguments of one case, the frame hash at the end of every
+// sweep and at the end of the run, and upper bounds on the SPI bytes and
+// commands of every sweep. "make -C host golden" runs all cases. A case also
+// fails if the screen check finds a wrong pixel or an SCI byte was lost, and
+// no manifest is written from such a run.
+//
+//   args -s 3 -m 1
+//   sweep 1 0d9838ad 56000 1300     hash, max bytes, max commands
+//   final 0d9838ad
+
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <stdio.h>
+
+#define GOLDEN_SWEEPS   64
+#define GOLDEN_SLACK    5       // percent added to the SPI traffic when the bounds are written
+
+int golden_load(const char *path);
+void golden_start(unsigned long long start, double period, int sweeps);
+int golden_finish(FILE *out, int wrong, unsigned long lost);
+int golden_write(const char *path, int argc, char **argv);
+
+#endif
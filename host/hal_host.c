@@ -0,0 +1,79 @@
+// hal_host.c
+// Author: Joseph Dobrzanski
+// Host versions of the hardware accesses in hal.h.
+
+#include "hal.h"
+#include "vpanel.h"
+#include "bios_host.h"
+#include "cost.h"
+
+Uint16 hal_cpu_pin = 1;
+Uint16 hal_lcd_dc = 1;
+FILE *hal_sci_out = NULL;
+Uint16 hal_selftest_pin = 0;
+Uint16 hal_sci_overrun = 0;
+
+static Uint16 sci_fifo[HAL_SCI_FIFO];
+static Uint16 sci_head = 0;
+static Uint16 sci_count = 0;
+static unsigned long long timer_start = 0;
+
+// spi_send() waits until the byte is on the wire
+Uint16 hal_spi_send(Uint16 data)
+{
+    vpanel_byte(hal_lcd_dc, data & 0xFF);
+    cost_charge(COST_SPI_BYTE, 1);
+    return 0;
+}
+
+Uint16 hal_sci_count(void)
+{
+    return sci_count;
+}
+
+Uint16 hal_sci_read(void)
+{
+    Uint16 data = sci_fifo[sci_head];
+
+    if (sci_count == 0) return 0;
+    sci_head = (sci_head + 1) % HAL_SCI_FIFO;
+    sci_count--;
+    return data;
+}
+
+int hal_sci_write(Uint16 data)
+{
+    if (sci_count == HAL_SCI_FIFO) {
+        hal_sci_overrun = 1;
+        return 0;
+    }
+    sci_fifo[(sci_head + sci_count) % HAL_SCI_FIFO] = data & 0xFF;
+    sci_count++;
+    return 1;
+}
+
+void hal_sci_tx(Uint16 data)
+{
+    if (hal_sci_out != NULL) fputc(data & 0xFF, hal_sci_out);
+}
+
+void hal_delay(long ticks)
+{
+    cost_charge(COST_DELAY_TICK, ticks);
+}
+
+// CPU timer 1 counts modeled cycles
+void hal_timer_start(void)
+{
+    timer_start = bios_host_cycles;
+}
+
+Uint32 hal_timer_cycles(void)
+{
+    return (Uint32)(bios_host_cycles - timer_start);
+}
+
+// the peripherals are all modeled, nothing to set up
+void DeviceInit(void)
+{
+}
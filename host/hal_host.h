@@ -0,0 +1,47 @@
+// hal_host.h
+// Author: Joseph Dobrzanski
+// Host side of hal.h: the control pins are plain variables, SPIA feeds the
+// virtual panel (vpanel.c), SCIA receives from a FIFO filled by the scenario
+// and sends to hal_sci_out.
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include <stdio.h>
+#include "cost.h"
+
+#define HAL_SCI_FIFO    4       // same depth as the SCIA receive FIFO
+
+extern Uint16 hal_cpu_pin;      // GPIO6 as a measurement pin (1 = idle)
+extern Uint16 hal_lcd_dc;       // GPIO2 (0 = command, 1 = data)
+extern FILE *hal_sci_out;       // gets the bytes sent on SCI TX (none if NULL)
+extern Uint16 hal_selftest_pin; // S1 held at boot
+extern Uint16 hal_sci_overrun;  // RXFFOVF: a byte came in with the receive FIFO full
+
+#define HAL_CPU_IDLE()      (hal_cpu_pin = 1)
+#define HAL_CPU_BUSY()      (hal_cpu_pin = 0)
+#define HAL_LCD_COMMAND()   (hal_lcd_dc = 0)
+#define HAL_LCD_DATA()      (hal_lcd_dc = 1)
+#define HAL_LCD_SELECT()    ((void)0)
+#define HAL_SCI_RX_READY()  (hal_sci_count() > 0)
+#define HAL_SCI_RX_BYTE()   (hal_sci_read())
+#define HAL_SCI_TX_READY()  (1)
+#define HAL_SCI_TX_BYTE(b)  hal_sci_tx(b)
+#define HAL_SCI_RX_OVERRUN() (hal_sci_overrun)
+#define HAL_SCI_RX_OVERRUN_CLEAR() (hal_sci_overrun = 0)
+#define HAL_DELAY_HOOK(ticks) hal_delay(ticks)
+#define HAL_COST(op, n)     cost_charge(op, n)
+#define HAL_TIMER_START()   hal_timer_start()
+#define HAL_TIMER_CYCLES()  hal_timer_cycles()
+#define HAL_TIMER_STOP()    ((void)0)
+#define HAL_SELFTEST_PIN()  (hal_selftest_pin)
+
+Uint16 hal_sci_count(void);
+Uint16 hal_sci_read(void);
+int hal_sci_write(Uint16 data);     // scenario side, 0 if the FIFO is full (byte lost)
+void hal_sci_tx(Uint16 data);
+void hal_delay(long ticks);
+void hal_timer_start(void);
+Uint32 hal_timer_cycles(void);
+
+#endif
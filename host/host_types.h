@@ -0,0 +1,20 @@
+// host_types.h
+// Author: Joseph Dobrzanski
+// C2000 integer types for the host build (forced in with -include ahead of
+// F2802x_Device.h). int is 16 bits on the C28x, so the DSP28 types are mapped
+// to fixed-width types to keep the same wraparound on a 32/64-bit host.
+
+#ifndef HOST_TYPES_H
+#define HOST_TYPES_H
+
+#include <stdint.h>
+
+#define DSP28_DATA_TYPES
+typedef int16_t         int16;
+typedef int32_t         int32;
+typedef uint16_t        Uint16;
+typedef uint32_t        Uint32;
+typedef float           float32;
+typedef long double     float64;
+
+#endif
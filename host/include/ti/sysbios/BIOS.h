@@ -0,0 +1,15 @@
+// ti/sysbios/BIOS.h (host build)
+// Author: Joseph Dobrzanski
+
+#ifndef TI_SYSBIOS_BIOS_H
+#define TI_SYSBIOS_BIOS_H
+
+#include <xdc/std.h>
+
+#define BIOS_WAIT_FOREVER   (~(UInt)0)
+#define BIOS_NO_WAIT        0
+
+// creates the static tasks and returns (the simulator then drives the threads)
+Void BIOS_start(Void);
+
+#endif
@@ -0,0 +1,10 @@
+// ti/sysbios/family/c28/Hwi.h (host build)
+// Author: Joseph Dobrzanski
+// The host has one Hwi module; the c28 handle is the same object.
+
+#ifndef TI_SYSBIOS_FAMILY_C28_HWI_H
+#define TI_SYSBIOS_FAMILY_C28_HWI_H
+
+#include <ti/sysbios/hal/Hwi.h>
+
+#endif
@@ -0,0 +1,23 @@
+// ti/sysbios/hal/Hwi.h (host build)
+// Author: Joseph Dobrzanski
+// Hwis are raised by events scheduled with bios_host_raise() (bios_host.c).
+
+#ifndef TI_SYSBIOS_HAL_HWI_H
+#define TI_SYSBIOS_HAL_HWI_H
+
+#include <xdc/std.h>
+#include "bios_host_stats.h"
+
+struct Hwi_Object {
+    const char *name;
+    Int intNum;
+    Void (*fxn)(Void);
+    struct bios_host_stats stats;
+};
+
+typedef struct Hwi_Object *Hwi_Handle;
+
+UInt Hwi_disable(Void);
+Void Hwi_restore(UInt key);
+
+#endif
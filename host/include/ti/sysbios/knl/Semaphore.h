@@ -0,0 +1,32 @@
+// ti/sysbios/knl/Semaphore.h (host build)
+// Author: Joseph Dobrzanski
+
+#ifndef TI_SYSBIOS_KNL_SEMAPHORE_H
+#define TI_SYSBIOS_KNL_SEMAPHORE_H
+
+#include <xdc/std.h>
+#include "bios_host_stats.h"
+
+#define Semaphore_Mode_COUNTING 0
+#define Semaphore_Mode_BINARY   1
+
+#define SEMAPHORE_POST_TIMES    32  // post times kept for the latency of the pends that take them
+
+struct Semaphore_Object {
+    const char *name;
+    Int count;
+    Int mode;
+    // scheduler state
+    unsigned long long post_time[SEMAPHORE_POST_TIMES];
+    UInt post_head;
+    UInt post_count;
+    struct bios_host_stats stats;   // latency = time blocked in Semaphore_pend()
+};
+
+typedef struct Semaphore_Object *Semaphore_Handle;
+
+Bool Semaphore_pend(Semaphore_Handle sem, UInt timeout);
+Void Semaphore_post(Semaphore_Handle sem);
+Int Semaphore_getCount(Semaphore_Handle sem);
+
+#endif
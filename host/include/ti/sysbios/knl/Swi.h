@@ -0,0 +1,26 @@
+// ti/sysbios/knl/Swi.h (host build)
+// Author: Joseph Dobrzanski
+
+#ifndef TI_SYSBIOS_KNL_SWI_H
+#define TI_SYSBIOS_KNL_SWI_H
+
+#include <xdc/std.h>
+#include "bios_host_stats.h"
+
+struct Swi_Object {
+    const char *name;
+    Void (*fxn)(UArg arg);
+    UArg arg;
+    Int priority;
+    // scheduler state
+    Bool posted;
+    unsigned long long posted_at;
+    unsigned long merged;       // posts that came in while already posted (run once for both)
+    struct bios_host_stats stats;
+};
+
+typedef struct Swi_Object *Swi_Handle;
+
+Void Swi_post(Swi_Handle swi);
+
+#endif
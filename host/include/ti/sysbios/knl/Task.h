@@ -0,0 +1,38 @@
+// ti/sysbios/knl/Task.h (host build)
+// Author: Joseph Dobrzanski
+// Tasks are coroutines on the host; the scheduler is in bios_host.c.
+
+#ifndef TI_SYSBIOS_KNL_TASK_H
+#define TI_SYSBIOS_KNL_TASK_H
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include "bios_host_stats.h"
+
+struct Task_Object {
+    const char *name;
+    Void (*fxn)(Void);
+    Int priority;
+    Semaphore_Handle work;      // a job runs from a pend on this semaphore to the next one
+    // scheduler state
+    Int mode;                   // Task_Mode_*
+    Semaphore_Handle pending;   // semaphore the task is blocked on
+    unsigned long long pend_start;
+    long order;                 // position in the ready queue of its priority
+    Bool in_job;
+    unsigned long long release; // post time of the running job
+    Void *context;
+    struct bios_host_stats stats;
+};
+
+typedef struct Task_Object *Task_Handle;
+
+#define Task_Mode_RUNNING   0
+#define Task_Mode_READY     1
+#define Task_Mode_BLOCKED   2
+#define Task_Mode_TERMINATED 3
+
+Void Task_yield(Void);
+Task_Handle Task_self(Void);
+
+#endif
@@ -0,0 +1,11 @@
+// ti/sysbios/utils/Load.h (host build)
+// Author: Joseph Dobrzanski
+
+#ifndef TI_SYSBIOS_UTILS_LOAD_H
+#define TI_SYSBIOS_UTILS_LOAD_H
+
+#include <xdc/std.h>
+
+UInt32 Load_getCPULoad(Void);
+
+#endif
@@ -0,0 +1,18 @@
+// xdc/runtime/Timestamp.h (host build)
+// Author: Joseph Dobrzanski
+// Timestamps count the simulator's virtual CPU cycles (bios_host.c).
+
+#ifndef XDC_RUNTIME_TIMESTAMP_H
+#define XDC_RUNTIME_TIMESTAMP_H
+
+#include <xdc/std.h>
+
+typedef struct Types_FreqHz {
+    Bits32 hi;
+    Bits32 lo;
+} Types_FreqHz;
+
+Bits32 Timestamp_get32(void);
+void Timestamp_getFreq(Types_FreqHz *freq);
+
+#endif
@@ -0,0 +1,23 @@
+// xdc/std.h (host build)
+// Author: Joseph Dobrzanski
+// The XDC base types used by the firmware.
+
+#ifndef XDC_STD_H
+#define XDC_STD_H
+
+#include <stdint.h>
+
+typedef void            Void;
+typedef int             Int;
+typedef unsigned int    UInt;
+typedef int             Bool;
+typedef char            Char;
+typedef void           *Ptr;
+typedef uintptr_t       UArg;
+typedef uint32_t        Bits32;
+typedef uint32_t        UInt32;
+
+#define TRUE    1
+#define FALSE   0
+
+#endif
@@ -0,0 +1,127 @@
+// replay.c
+// Author: Joseph Dobrzanski
+// Each record of the trace becomes the event it was recorded from, at the same
+// time relative to the first record: encoder and IR records raise their Hwi,
+// sample records put the distance byte into the SCI FIFO. Only the next record
+// is queued at any time, so traces of any length replay in constant memory.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+#include "trace.h"
+#include "sim.h"
+#include "replay.h"
+
+struct replay_counts replay_counts;
+
+static unsigned char *records = NULL;
+static long length = 0;
+static long pos = 0;
+static double unit = 1;            // host cycles per delta unit
+static unsigned long long when;     // time of the record at "pos"
+
+// read the record at "pos": its delta, type and distance byte; 0 at the end or on a broken record
+static int parse(unsigned long *delta, int *type, int *data)
+{
+    int shift = 5;
+    unsigned char b;
+
+    if (pos >= length) return 0;
+    b = records[pos++];
+    *type = b >> 6;
+    *delta = b & 0x1F;
+    while (b & ((shift == 5) ? 0x20 : 0x80)) {
+        if (pos >= length) return 0;
+        b = records[pos++];
+        *delta |= (unsigned long)(b & 0x7F) << shift;
+        shift += 7;
+    }
+    *data = 0;
+    if (*type == TRACE_SAMPLE) {
+        if (pos >= length) return 0;
+        *data = records[pos++];
+    }
+    return 1;
+}
+
+static unsigned long u32(const unsigned char *p)
+{
+    return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) | ((unsigned long)p[2] << 8) | p[3];
+}
+
+int replay_load(const char *path)
+{
+    FILE *in = fopen(path, "rb");
+    unsigned char header[TRACE_HEADER];
+    unsigned long freq;
+
+    if (in == NULL) {
+        perror(path);
+        return -1;
+    }
+    if ((fread(header, 1, TRACE_HEADER, in) != TRACE_HEADER) || (memcmp(header, "LTR1", 4) != 0)) {
+        fprintf(stderr, "%s: not a trace dump\n", path);
+        fclose(in);
+        return -1;
+    }
+    freq = u32(&header[6]);
+    length = ((long)header[10] << 8) | header[11];
+    records = malloc(length ? length : 1);
+    if ((records == NULL) || (fread(records, 1, length, in) != (size_t)length) || (freq == 0)) {
+        fprintf(stderr, "%s: truncated trace\n", path);
+        fclose(in);
+        return -1;
+    }
+    fclose(in);
+    unit = (double)(1UL << header[4]) * BIOS_HOST_CPU_HZ / freq;
+    return 0;
+}
+
+// deliver the record at "pos", then queue the next one
+static void replay_event(UArg unused)
+{
+    unsigned long delta;
+    int type, data;
+    long next;
+
+    (void)unused;
+    if (!parse(&delta, &type, &data)) return;
+    if (type == TRACE_ENCODER) {
+        bios_host_raise(bios_host_cycles, hwi0);
+        replay_counts.encoder++;
+    } else if (type == TRACE_IR) {
+        bios_host_raise(bios_host_cycles, hwi1);
+        replay_counts.ir++;
+    } else if (type == TRACE_SAMPLE) {
+        sim_sci_arrival(data);
+        replay_counts.samples++;
+    }
+
+    // peek at the next record for its time
+    next = pos;
+    if (parse(&delta, &type, &data)) {
+        when += (unsigned long long)(delta * unit);
+        bios_host_device(when, replay_event, 0);
+    }
+    pos = next;
+}
+
+// queue the first record at "start", returns the time of the last record
+unsigned long long replay_start(unsigned long long start)
+{
+    unsigned long delta;
+    unsigned long long last = start;
+    int type, data;
+
+    // the first delta is from an event that is no longer in the trace
+    pos = 0;
+    if (parse(&delta, &type, &data)) {
+        while (parse(&delta, &type, &data)) last += (unsigned long long)(delta * unit);
+    }
+    pos = 0;
+    when = start;
+    memset(&replay_counts, 0, sizeof(replay_counts));
+    if (length > 0) bios_host_device(start, replay_event, 0);
+    return last;
+}
@@ -0,0 +1,19 @@
+// replay.h
+// Author: Joseph Dobrzanski
+// Replays an input trace dumped by the firmware (trace.h) into the host build.
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+struct replay_counts {
+    unsigned long encoder;
+    unsigned long ir;
+    unsigned long samples;
+};
+
+extern struct replay_counts replay_counts;
+
+int replay_load(const char *path);
+unsigned long long replay_start(unsigned long long start);
+
+#endif
@@ -0,0 +1,203 @@
+// scene.c
+// Author: Joseph Dobrzanski
+// Ray casting of the scene and the event generator for a workload. The
+// generator is one device event per encoder count that raises the encoder
+// (and at each revolution the IR) interrupt and queues the samples that arrive
+// before the next count, so only about one count of events is queued at a time.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "hal.h"
+#include "main_file.h"
+#include "bios_host.h"
+#include "sim.h"
+#include "scene.h"
+
+extern int16 array_index;   // main_file.c
+extern int16 clear_index;
+
+struct workload_stats workload_stats;
+
+static const struct scene *cur_scene;
+static unsigned long long cur_start;
+static double rev_cycles, count_cycles, sample_cycles;
+static double next_sample;
+static unsigned long counts_left;
+static unsigned long random_state = 1;
+
+void scene_default(struct scene *scene)
+{
+    memset(scene, 0, sizeof(*scene));
+    // square room, 100 units across, with a target going round at 30 units
+    scene->walls[0] = (struct scene_wall){ -50, -50, 50, -50 };
+    scene->walls[1] = (struct scene_wall){ 50, -50, 50, 50 };
+    scene->walls[2] = (struct scene_wall){ 50, 50, -50, 50 };
+    scene->walls[3] = (struct scene_wall){ -50, 50, -50, -50 };
+    scene->num_walls = 4;
+    scene->targets[0] = (struct scene_target){ 30, 0, 5, 0, 0, 10 };
+    scene->num_targets = 1;
+    scene->seed = 1;
+}
+
+int scene_load(struct scene *scene, const char *path)
+{
+    FILE *in = fopen(path, "r");
+    char line[256], word[32];
+    struct scene_wall w;
+    struct scene_target t;
+    int n = 0;
+
+    if (in == NULL) {
+        perror(path);
+        return -1;
+    }
+    memset(scene, 0, sizeof(*scene));
+    scene->seed = 1;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        n++;
+        if ((strchr(line, '#') != NULL)) *strchr(line, '#') = 0;
+        if (sscanf(line, "%31s", word) != 1) continue;
+        memset(&t, 0, sizeof(t));
+        if ((strcmp(word, "wall") == 0) && (sscanf(line, "%*s %lf %lf %lf %lf", &w.x0, &w.y0, &w.x1, &w.y1) == 4)
+            && (scene->num_walls < SCENE_WALLS)) {
+            scene->walls[scene->num_walls++] = w;
+        } else if ((strcmp(word, "target") == 0) && (scene->num_targets < SCENE_TARGETS)
+                   && (sscanf(line, "%*s %lf %lf %lf %lf %lf", &t.x, &t.y, &t.radius, &t.vx, &t.vy) == 5)) {
+            scene->targets[scene->num_targets++] = t;
+        } else if ((strcmp(word, "orbit") == 0) && (scene->num_targets < SCENE_TARGETS)
+                   && (sscanf(line, "%*s %lf %lf %lf", &t.x, &t.radius, &t.orbit_rate) == 3)) {
+            scene->targets[scene->num_targets++] = t;
+        } else if ((strcmp(word, "noise") == 0) && (sscanf(line, "%*s %lf", &scene->noise) == 1)) {
+        } else if ((strcmp(word, "dropout") == 0) && (sscanf(line, "%*s %lf", &scene->dropout) == 1)) {
+        } else if ((strcmp(word, "seed") == 0) && (sscanf(line, "%*s %lu", &scene->seed) == 1)) {
+        } else {
+            fprintf(stderr, "%s:%d: cannot read \"%s\"\n", path, n, word);
+            fclose(in);
+            return -1;
+        }
+    }
+    fclose(in);
+    return 0;
+}
+
+// distance along the ray (dx, dy) to the segment, -1 if it misses
+static double hit_wall(const struct scene_wall *w, double dx, double dy)
+{
+    double ex = w->x1 - w->x0, ey = w->y1 - w->y0;
+    double den = dx * ey - dy * ex;
+    double t, u;
+
+    if (fabs(den) < 1e-12) return -1;
+    t = (w->x0 * ey - w->y0 * ex) / den;    // along the ray
+    u = (w->x0 * dy - w->y0 * dx) / den;    // along the segment
+    return ((t > 0) && (u >= 0) && (u <= 1)) ? t : -1;
+}
+
+// distance along the ray (dx, dy) to the circle, -1 if it misses
+static double hit_target(const struct scene_target *tg, double seconds, double dx, double dy)
+{
+    double cx, cy, along, miss, a;
+
+    if (tg->orbit_rate != 0) {
+        a = tg->orbit_rate * seconds * M_PI / 180.0;
+        cx = tg->x * cos(a);
+        cy = tg->x * sin(a);
+    } else {
+        cx = tg->x + tg->vx * seconds;
+        cy = tg->y + tg->vy * seconds;
+    }
+    along = cx * dx + cy * dy;
+    miss = cx * dy - cy * dx;
+    if ((along <= 0) || (fabs(miss) >= tg->radius)) return -1;
+    return along - sqrt(tg->radius * tg->radius - miss * miss);
+}
+
+// nearest hit at "degrees" and time "seconds", SCENE_MAX_RANGE if nothing is hit
+double scene_range(const struct scene *scene, double degrees, double seconds)
+{
+    double a = degrees * M_PI / 180.0;
+    double dx = cos(a), dy = sin(a);
+    double best = SCENE_MAX_RANGE, d;
+    int i;
+
+    for (i = 0; i < scene->num_walls; i++) {
+        d = hit_wall(&scene->walls[i], dx, dy);
+        if ((d >= 0) && (d < best)) best = d;
+    }
+    for (i = 0; i < scene->num_targets; i++) {
+        d = hit_target(&scene->targets[i], seconds, dx, dy);
+        if ((d >= 0) && (d < best)) best = d;
+    }
+    return best;
+}
+
+// uniform in [0, 1)
+static double random_unit(void)
+{
+    random_state ^= (random_state << 13) & 0xFFFFFFFFUL;
+    random_state ^= random_state >> 17;
+    random_state ^= (random_state << 5) & 0xFFFFFFFFUL;
+    return (random_state & 0xFFFFFF) / (double)0x1000000;
+}
+
+static double random_gauss(void)
+{
+    double u = random_unit() + 1e-9;
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * random_unit());
+}
+
+// the LIDAR sample taken at "t" cycles after the start
+static void sample_at(double t)
+{
+    double seconds = t / BIOS_HOST_CPU_HZ;
+    double degrees = fmod(t, rev_cycles) * 360.0 / rev_cycles;
+    double d;
+
+    if ((cur_scene->dropout > 0) && (random_unit() < cur_scene->dropout)) {
+        workload_stats.dropouts++;
+        return;
+    }
+    d = scene_range(cur_scene, degrees, seconds);
+    if (cur_scene->noise > 0) d += cur_scene->noise * random_gauss();
+    if (d < 0) d = 0;
+    if (d > SCENE_MAX_RANGE) d = SCENE_MAX_RANGE;
+    bios_host_device(cur_start + (unsigned long long)t, sim_sci_arrival, (UArg)(d + 0.5));
+    workload_stats.samples++;
+}
+
+// encoder count "k" since the start: raise its interrupts, queue the samples that
+// arrive before the next count, and come back for the next count
+static void count_event(UArg k)
+{
+    double at = k * count_cycles;
+    double rev_at = ceil(at / rev_cycles) * rev_cycles;
+    int lag = (array_index - clear_index + NUM_POINTS) % NUM_POINTS;
+
+    if (lag > workload_stats.max_lag) workload_stats.max_lag = lag;
+    workload_stats.ticks++;
+    // the encoder moves on at every count, the IR pulse marks the start of each revolution
+    if (k > 0) bios_host_raise(cur_start + (unsigned long long)at, hwi0);
+    if (rev_at < at + count_cycles) bios_host_raise(cur_start + (unsigned long long)rev_at, hwi1);
+    for (; next_sample < at + count_cycles; next_sample += sample_cycles) {
+        sample_at(next_sample);
+    }
+    if (--counts_left > 0) bios_host_device(cur_start + (unsigned long long)(at + count_cycles), count_event, k + 1);
+}
+
+// queue the inputs of "load" from "start" on, returns the time the last revolution ends
+unsigned long long workload_start(const struct scene *scene, const struct workload *load, unsigned long long start)
+{
+    cur_scene = scene;
+    cur_start = start;
+    rev_cycles = BIOS_HOST_CPU_HZ * 60.0 / load->rpm;
+    count_cycles = rev_cycles / load->counts;
+    sample_cycles = (load->rate > 0) ? BIOS_HOST_CPU_HZ / load->rate : count_cycles;
+    next_sample = sample_cycles / 2;
+    counts_left = (unsigned long)ceil(load->revs * load->counts);
+    random_state = scene->seed ? scene->seed : 1;
+    memset(&workload_stats, 0, sizeof(workload_stats));
+    bios_host_device(start, count_event, 0);
+    return start + (unsigned long long)(load->revs * rev_cycles);
+}
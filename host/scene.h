@@ -0,0 +1,65 @@
+// scene.h
+// Author: Joseph Dobrzanski
+// Synthetic scenes and workloads for the host build. A scene is what the
+// LIDAR sees (walls, moving targets, noise, dropouts); a workload is how fast
+// the motor turns and the LIDAR samples. workload_start() turns both into the
+// encoder, IR and SCI events of the simulated inputs.
+//
+// Scene file, one item per line, '#' starts a comment, distances in raw
+// LIDAR units with the platform at (0, 0), x at 0 degrees, y at 90 degrees:
+//   wall x0 y0 x1 y1               line segment
+//   target x y radius vx vy        circle moving at (vx, vy) units/s
+//   orbit range radius deg_per_s   circle going round the platform
+//   noise sigma                    gaussian range noise (units)
+//   dropout p                      probability a sample is not sent
+//   seed n                         noise and dropout random seed
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#define SCENE_WALLS     32
+#define SCENE_TARGETS   16
+#define SCENE_MAX_RANGE 255     // one SCI byte; also sent when nothing is hit
+
+struct scene_wall {
+    double x0, y0, x1, y1;
+};
+
+struct scene_target {
+    double x, y, radius;
+    double vx, vy;          // units/s (straight targets)
+    double orbit_rate;      // deg/s around the platform, 0 = straight
+};
+
+struct scene {
+    struct scene_wall walls[SCENE_WALLS];
+    int num_walls;
+    struct scene_target targets[SCENE_TARGETS];
+    int num_targets;
+    double noise;
+    double dropout;
+    unsigned long seed;
+};
+
+struct workload {
+    double rpm;             // motor speed
+    double counts;          // encoder counts per revolution (the firmware expects NUM_BINS)
+    double rate;            // LIDAR samples per second, 0 = one per encoder count
+    int revs;               // revolutions to run
+};
+
+struct workload_stats {
+    unsigned long ticks;
+    unsigned long samples;  // bytes sent to the SCI
+    unsigned long dropouts; // samples the scene dropped
+    int max_lag;            // most bins the clear task was behind the encoder at a tick
+};
+
+extern struct workload_stats workload_stats;
+
+void scene_default(struct scene *scene);
+int scene_load(struct scene *scene, const char *path);
+double scene_range(const struct scene *scene, double degrees, double seconds);
+unsigned long long workload_start(const struct scene *scene, const struct workload *load, unsigned long long start);
+
+#endif
@@ -0,0 +1,17 @@
+// sim.h
+// Author: Joseph Dobrzanski
+// Inputs of the simulated stationary module, shared by the scene (scene.c, sim_main.c)
+// and the trace replayer (replay.c).
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "bios_host.h"
+
+extern const Hwi_Handle hwi0;   // encoder_Fxn
+extern const Hwi_Handle hwi1;   // IR_Fxn
+extern unsigned long sim_sci_lost;
+
+void sim_sci_arrival(UArg distance);
+
+#endif
@@ -0,0 +1,67 @@
+// sim_cfg.c
+// Author: Joseph Dobrzanski
+// Host copy of the static SYS/BIOS objects in main_file.cfg (keep the two in step).
+
+#include <xdc/std.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Swi.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include "bios_host.h"
+
+extern Void encoder_Fxn(Void);
+extern Void IR_Fxn(Void);
+extern Void polar_to_cart_Fxn(UArg arg);
+extern Void draw_point_Fxn(Void);
+extern Void clear_point_Fxn(Void);
+extern Void redraw_point_Fxn(Void);
+extern Void myIdleFxn(Void);
+extern Void evtrace_hwi_begin(Hwi_Handle hwi);
+extern Void evtrace_hwi_end(Hwi_Handle hwi);
+extern Void evtrace_swi_begin(Swi_Handle swi);
+extern Void evtrace_swi_end(Swi_Handle swi);
+extern Void evtrace_task_switch(Task_Handle prev, Task_Handle next);
+
+static struct Hwi_Object hwi0_obj = { .name = "encoder_Fxn", .intNum = 35, .fxn = encoder_Fxn };
+static struct Hwi_Object hwi1_obj = { .name = "IR_Fxn", .intNum = 36, .fxn = IR_Fxn };
+const Hwi_Handle hwi0 = &hwi0_obj;
+const Hwi_Handle hwi1 = &hwi1_obj;
+
+static struct Swi_Object mySwi_obj = { .name = "mySwi", .fxn = polar_to_cart_Fxn, .priority = 0 };
+const Swi_Handle mySwi = &mySwi_obj;
+
+static struct Semaphore_Object draw_Sem_obj = { .name = "draw_Sem", .count = 0, .mode = Semaphore_Mode_COUNTING };
+static struct Semaphore_Object lock_Sem_obj = { .name = "lock_Sem", .count = 1, .mode = Semaphore_Mode_BINARY };
+static struct Semaphore_Object clear_Sem_obj = { .name = "clear_Sem", .count = 0, .mode = Semaphore_Mode_COUNTING };
+static struct Semaphore_Object redraw_Sem_obj = { .name = "redraw_Sem", .count = 0, .mode = Semaphore_Mode_COUNTING };
+const Semaphore_Handle draw_Sem = &draw_Sem_obj;
+const Semaphore_Handle lock_Sem = &lock_Sem_obj;
+const Semaphore_Handle clear_Sem = &clear_Sem_obj;
+const Semaphore_Handle redraw_Sem = &redraw_Sem_obj;
+
+// in the order Task.create() is called in main_file.cfg ("work" is the semaphore a job starts with)
+static struct Task_Object draw_point_obj = { .name = "draw_point", .fxn = draw_point_Fxn, .priority = 1, .work = &draw_Sem_obj };
+static struct Task_Object clear_point_obj = { .name = "clear_point", .fxn = clear_point_Fxn, .priority = 2, .work = &clear_Sem_obj };
+static struct Task_Object redraw_point_obj = { .name = "redraw_point", .fxn = redraw_point_Fxn, .priority = 1, .work = &redraw_Sem_obj };
+const Task_Handle draw_point = &draw_point_obj;
+const Task_Handle clear_point = &clear_point_obj;
+const Task_Handle redraw_point = &redraw_point_obj;
+
+Hwi_Handle const bios_host_hwis[] = { &hwi0_obj, &hwi1_obj };
+const Int bios_host_num_hwis = sizeof(bios_host_hwis) / sizeof(bios_host_hwis[0]);
+Swi_Handle const bios_host_swis[] = { &mySwi_obj };
+const Int bios_host_num_swis = sizeof(bios_host_swis) / sizeof(bios_host_swis[0]);
+Task_Handle const bios_host_tasks[] = { &draw_point_obj, &clear_point_obj, &redraw_point_obj };
+const Int bios_host_num_tasks = sizeof(bios_host_tasks) / sizeof(bios_host_tasks[0]);
+Semaphore_Handle const bios_host_semaphores[] = { &lock_Sem_obj };
+const Int bios_host_num_semaphores = sizeof(bios_host_semaphores) / sizeof(bios_host_semaphores[0]);
+
+Void (*const bios_host_idle)(Void) = myIdleFxn;
+
+const struct bios_host_hooks bios_host_hooks = {
+    .hwi_begin = evtrace_hwi_begin,
+    .hwi_end = evtrace_hwi_end,
+    .swi_begin = evtrace_swi_begin,
+    .swi_end = evtrace_swi_end,
+    .task_switch = evtrace_task_switch
+};
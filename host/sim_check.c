@@ -0,0 +1,68 @@
+// sim_check.c
+// Author: Joseph Dobrzanski
+// Screen check for the polar view. Every pixel inside the rim must show the
+// color of its best owner (render.c) or its background layer. Only the sweep
+// line pixels its current move has not sent yet are skipped (sweep_line_pending()).
+// A wrong pixel means a thread drew or erased with state that changed under it
+// (array_index, last_point, ...). Run it when the threads are idle and the
+// clear task has caught up with the sweep.
+
+#include <math.h>
+#include "main_file.h"
+#include "render.h"
+#include "layers.h"
+#include "sweep_line.h"
+#include "spi_screen.h"
+#include "vpanel.h"
+#include "sim_check.h"
+
+#define CHECK_REPORT    8   // wrong pixels listed
+
+// bin whose angle is closest to the direction of (x, y) from the disc center
+static int16 bin_at(int16 x, int16 y)
+{
+    double degrees = atan2(y - DISC_Y, x - DISC_X) * 180.0 / M_PI;
+
+    if (degrees < 0) degrees += 360.0;
+    return (int16)floor(degrees * SF / ENCODER_ANG + 0.5) % NUM_BINS;
+}
+
+// color (x, y) should have
+static Uint16 expected_color(int16 x, int16 y)
+{
+    int16 bin = bin_at(x, y);
+    Uint16 best = SHADE_NONE, shade;
+    int16 d;
+
+    for (d = -1; d <= 1; d++) {
+        shade = pixel_shade(x, y, (bin + d + NUM_BINS) % NUM_BINS);
+        if (shade < best) best = shade;
+    }
+    return (best < SHADE_NONE) ? history_palette[best] : (Uint16)layer_color(x, y);
+}
+
+// number of wrong pixels, the first few are listed on "out"
+int sim_check_screen(FILE *out)
+{
+    int16 r = DISC_R - RIM_WIDTH;
+    int16 x, y;
+    Uint16 want, got;
+    int wrong = 0;
+
+    if (display_mode != DISPLAY_POLAR) return 0;
+    for (y = DISC_Y - r + 1; y < DISC_Y + r; y++) {
+        for (x = DISC_X - r + 1; x < DISC_X + r; x++) {
+            if ((int32)(x - DISC_X) * (x - DISC_X) + (int32)(y - DISC_Y) * (y - DISC_Y) >= (int32)r * r) continue;
+            if ((x == DISC_X) && (y == DISC_Y)) continue;
+            got = vpanel_pixel(x, y);
+            if (sweep_line_pending(x, y)) continue;
+            want = expected_color(x, y);
+            if (got == want) continue;
+            if (wrong < CHECK_REPORT) {
+                fprintf(out, "pixel (%d, %d) is %04X, expected %04X (bin %d)\n", x, y, got, want, bin_at(x, y));
+            }
+            wrong++;
+        }
+    }
+    return wrong;
+}
@@ -0,0 +1,12 @@
+// sim_check.h
+// Author: Joseph Dobrzanski
+// Compares the virtual panel with what the point store says should be on screen.
+
+#ifndef SIM_CHECK_H
+#define SIM_CHECK_H
+
+#include <stdio.h>
+
+int sim_check_screen(FILE *out);
+
+#endif
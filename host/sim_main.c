@@ -0,0 +1,461 @@
+// sim_main.c
+// Author: Joseph Dobrzanski
+// Host simulation of the stationary module: runs the firmware in virtual time
+// (bios_host.c) against a virtual ST7735 and a synthetic scene (scene.c, a
+// square room with a target circling inside it unless -g gives a scene file).
+// The encoder, IR and SCI events come at the times the motor and the LIDAR
+// would produce them. With -R they come from an input trace dumped by the
+// firmware instead (replay.c).
+//
+//   sim [-s sweeps] [-r rpm] [-e counts/rev] [-f samples/s] [-g scene]
+//       [-m display_mode] [-z zoom_select] [-S seed] [-j jitter_us]
+//       [-C cost=cycles] [-o file.ppm] [-R trace.bin] [-T trace.bin] [-E events.bin]
+//       [-L rpm|rate|counts=from:to:step] [-G|-W golden.gold] [-B] [-P WxH]
+//
+// -T dumps the firmware's input trace (trace.c) into a file at the end, -E its
+// event trace (evtrace.c, convert with ./ctrace).
+// -S and -j randomize the interleaving of the threads (same seed, same run).
+// -C changes one of the costs in bios_host_costs (hwi, swi, semaphore,
+// task_switch, idle, spi_byte, delay_tick, div32, div16, mul32, owner).
+// -L ramps the motor speed, the sample rate or the encoder resolution, runs a
+// freshly booted firmware at each step and prints where the CPU time went,
+// marking the first step that saturates.
+// -B starts the firmware with S1.1 set, so it prints its self-test (selftest.c).
+// -G checks the frame at the end of every sweep and the SPI traffic against a
+// golden manifest (golden.c), -W writes one from this run.
+// -P draws into a WxH framebuffer (display_mem.c) instead of the virtual ST7735,
+// to run the rendering on another panel size; the SPI bytes are charged the same
+// but the command delays are not.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "hal.h"
+#include "main_file.h"
+#include "coord.h"
+#include "spi_screen.h"
+#include "bios_host.h"
+#include "vpanel.h"
+#include "sim_check.h"
+#include "trace.h"
+#include "evtrace.h"
+#include "latency.h"
+#include "perf.h"
+#include "sim.h"
+#include "replay.h"
+#include "scene.h"
+#include "cost.h"
+#include "golden.h"
+#include "display_mem.h"
+
+extern int firmware_main(void);
+extern const Swi_Handle mySwi;
+extern const Task_Handle draw_point, clear_point, redraw_point;
+
+unsigned long sim_sci_lost = 0;
+
+// what one run at one load did, also passed from a load point's child to the parent
+struct load_result {
+    double load;                // value of the ramped parameter
+    unsigned long samples;
+    unsigned long lost;         // bytes the SCI FIFO had no room for
+    unsigned long conversions;  // polar_to_cart_Fxn runs
+    unsigned long merged;       // Swi posts merged into a pending run
+    unsigned long missed;       // Swi and task responses over their deadline
+    int max_lag;
+    unsigned long long elapsed;
+    unsigned long long hwi, swi, task[3], idle, spi;    // cycles
+    unsigned long bytes;        // SPI bytes per sweep
+    unsigned long p99;          // sample-to-photon latency, us (latency.c)
+};
+
+static struct scene scene;
+static struct workload load = { MOTOR_MAX_RPM, NUM_BINS, 0, 3 };
+static int golden = 0;     // -G or -W: take a checkpoint at the end of every sweep
+
+// a LIDAR byte arrives at the SCI
+void sim_sci_arrival(UArg distance)
+{
+    if (!hal_sci_write((Uint16)distance)) sim_sci_lost++;
+}
+
+static void set_cost(const char *arg)
+{
+    static const struct { const char *name; unsigned long *cost; } costs[] = {
+        { "hwi", &bios_host_costs.hwi },
+        { "swi", &bios_host_costs.swi },
+        { "semaphore", &bios_host_costs.semaphore },
+        { "task_switch", &bios_host_costs.task_switch },
+        { "idle", &bios_host_costs.idle },
+        { "spi_byte", &bios_host_costs.spi_byte },
+        { "delay_tick", &bios_host_costs.delay_tick },
+        { "div32", &bios_host_costs.div32 },
+        { "div16", &bios_host_costs.div16 },
+        { "mul32", &bios_host_costs.mul32 },
+        { "owner", &bios_host_costs.owner },
+    };
+    const char *eq = strchr(arg, '=');
+    unsigned i;
+
+    for (i = 0; (eq != NULL) && (i < sizeof(costs) / sizeof(costs[0])); i++) {
+        if ((strlen(costs[i].name) == (size_t)(eq - arg)) && (strncmp(arg, costs[i].name, eq - arg) == 0)) {
+            *costs[i].cost = strtoul(eq + 1, NULL, 0);
+            return;
+        }
+    }
+    fprintf(stderr, "unknown cost \"%s\"\n", arg);
+    exit(2);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-s sweeps] [-r rpm] [-e counts/rev] [-f samples/s] [-g scene]\n"
+                    "       [-m display_mode] [-z zoom_select] [-S seed] [-j jitter_us]\n"
+                    "       [-C cost=cycles] [-o file.ppm] [-R trace.bin] [-T trace.bin] [-E events.bin]\n"
+                    "       [-L rpm|rate|counts=from:to:step] [-G|-W golden.gold] [-B] [-P WxH]\n", name);
+    exit(2);
+}
+
+static unsigned long long hwi_cycles(void)
+{
+    unsigned long long sum = 0;
+    Int i;
+
+    for (i = 0; i < bios_host_num_hwis; i++) sum += bios_host_hwis[i]->stats.cycles;
+    return sum;
+}
+
+static unsigned long missed(void)
+{
+    return mySwi->stats.missed + draw_point->stats.missed + clear_point->stats.missed + redraw_point->stats.missed;
+}
+
+// -P: draw into a framebuffer of the given size, allocated here (the firmware's buffers are
+// sized by DISPLAY_MAX_R, and display_select() refuses a larger disc)
+static int select_panel(const char *arg)
+{
+    int width, height;
+    Uint16 *fb;
+
+    if ((sscanf(arg, "%dx%d", &width, &height) != 2) || (width <= 0) || (height <= 0)) usage("sim");
+    fb = calloc((size_t)width * height, sizeof(Uint16));
+    if (fb == NULL) return -1;
+    display_mem_init(fb, width, height);
+    if (display_select(&display_mem) != 0) {
+        fprintf(stderr, "-P %s: the disc is larger than DISPLAY_MAX_R (%d)\n", arg, DISPLAY_MAX_R);
+        return -1;
+    }
+    return 0;
+}
+
+// run the workload from the current time, "r" gets what happened
+static void run_load(struct load_result *r)
+{
+    double period = BIOS_HOST_CPU_HZ * 60.0 / load.rpm;
+    double tick = period / load.counts;
+    unsigned long long start = bios_host_cycles;
+    struct load_result before;
+
+    // threads should be done before the next encoder tick, the Swi before the next sample
+    mySwi->stats.deadline = (unsigned long long)((load.rate > 0) ? BIOS_HOST_CPU_HZ / load.rate : tick);
+    draw_point->stats.deadline = (unsigned long long)tick;
+    clear_point->stats.deadline = (unsigned long long)tick;
+    redraw_point->stats.deadline = (unsigned long long)tick;
+
+    vpanel_reset_counts();
+    cost_reset();
+    latency_clear = 1;
+    latency_tick();
+    before.lost = sim_sci_lost;
+    before.conversions = mySwi->stats.runs;
+    before.merged = mySwi->merged;
+    before.missed = missed();
+    before.hwi = hwi_cycles();
+    before.swi = mySwi->stats.cycles;
+    before.task[0] = draw_point->stats.cycles;
+    before.task[1] = clear_point->stats.cycles;
+    before.task[2] = redraw_point->stats.cycles;
+    before.idle = bios_host_idle_cycles;
+
+    if (golden) golden_start(start, period, load.revs);
+    bios_host_run(workload_start(&scene, &load, start));
+
+    r->samples = workload_stats.samples;
+    r->lost = sim_sci_lost - before.lost;
+    r->conversions = mySwi->stats.runs - before.conversions;
+    r->merged = mySwi->merged - before.merged;
+    r->missed = missed() - before.missed;
+    r->max_lag = workload_stats.max_lag;
+    r->elapsed = bios_host_cycles - start;
+    r->hwi = hwi_cycles() - before.hwi;
+    r->swi = mySwi->stats.cycles - before.swi;
+    r->task[0] = draw_point->stats.cycles - before.task[0];
+    r->task[1] = clear_point->stats.cycles - before.task[1];
+    r->task[2] = redraw_point->stats.cycles - before.task[2];
+    r->idle = bios_host_idle_cycles - before.idle;
+    r->spi = vpanel_stats.bytes * (unsigned long long)bios_host_costs.spi_byte;
+    r->bytes = vpanel_stats.bytes / load.revs;
+    latency_update();
+    r->p99 = latency_p99;
+}
+
+// past the limit: samples are lost, the clear task falls a quarter sweep behind, or the CPU is never idle
+static int saturated(const struct load_result *r)
+{
+    return (r->lost * 100 > r->samples) || (r->max_lag > NUM_BINS / 4) || (r->idle * 20 < r->elapsed);
+}
+
+static double share(unsigned long long cycles, const struct load_result *r)
+{
+    return cycles * 100.0 / (r->elapsed ? r->elapsed : 1);
+}
+
+// -L: one child process per load point, so every point starts from a freshly booted firmware
+static int ramp(const char *arg)
+{
+    char name[16];
+    double from, to, step, v;
+    struct load_result r, first;
+    int fds[2], found = 0;
+    pid_t pid;
+
+    if ((sscanf(arg, "%15[a-z]=%lf:%lf:%lf", name, &from, &to, &step) != 4) || (step == 0)
+        || ((strcmp(name, "rpm") != 0) && (strcmp(name, "rate") != 0) && (strcmp(name, "counts") != 0))) {
+        fprintf(stderr, "bad load ramp \"%s\"\n", arg);
+        return 2;
+    }
+    printf("%8s  lost %%  merged  missed  lag    hwi    swi   draw  clear redraw   idle    spi  bytes/sweep  p99 ms\n", name);
+    for (v = from; (step > 0) ? (v <= to + 1e-9) : (v >= to - 1e-9); v += step) {
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        fflush(stdout);
+        pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            if (strcmp(name, "rpm") == 0) load.rpm = v;
+            if (strcmp(name, "rate") == 0) load.rate = v;
+            if (strcmp(name, "counts") == 0) load.counts = v;
+            vpanel_reset();
+            firmware_main();
+            bios_host_run(bios_host_cycles);
+            run_load(&r);
+            r.load = v;
+            _exit(write(fds[1], &r, sizeof(r)) == sizeof(r) ? 0 : 1);
+        }
+        close(fds[1]);
+        if ((pid < 0) || (read(fds[0], &r, sizeof(r)) != sizeof(r))) {
+            fprintf(stderr, "load point %g failed\n", v);
+            return 1;
+        }
+        close(fds[0]);
+        waitpid(pid, NULL, 0);
+
+        printf("%8g %7.2f %7lu %7lu %4d %5.1f%% %5.1f%% %5.1f%% %5.1f%% %5.1f%% %5.1f%% %5.1f%% %12lu %7.1f%s\n",
+               r.load, r.lost * 100.0 / (r.samples ? r.samples : 1), r.merged, r.missed, r.max_lag,
+               share(r.hwi, &r), share(r.swi, &r), share(r.task[0], &r), share(r.task[1], &r),
+               share(r.task[2], &r), share(r.idle, &r), share(r.spi, &r), r.bytes, r.p99 / 1000.0,
+               (!found && saturated(&r)) ? "  <- saturated" : "");
+        if (!found && saturated(&r)) {
+            found = 1;
+            first = r;
+        }
+    }
+    if (found) {
+        printf("saturates at %s=%g: %.2f%% samples lost, clear task %d bins behind, %.1f%% idle, "
+               "%.1f%% of the time waiting on SPI\n", name, first.load,
+               first.lost * 100.0 / (first.samples ? first.samples : 1), first.max_lag,
+               share(first.idle, &first), share(first.spi, &first));
+    } else {
+        printf("no saturation up to %s=%g\n", name, to);
+    }
+    return 0;
+}
+
+// share of the CPU time per thread as the firmware's event trace hooks saw it since BIOS_start()
+static void evtrace_report(void)
+{
+    static const char *const names[EVTRACE_THREADS] = {
+        "idle", "encoder", "IR", "swi", "draw", "clear", "redraw", "other"
+    };
+    double total = 0;
+    Int i;
+
+    for (i = 0; i < EVTRACE_THREADS; i++) total += evtrace_cycles[i];
+    if (total == 0) return;
+    printf("event trace   ");
+    for (i = 0; i < EVTRACE_THREADS; i++) {
+        if (evtrace_cycles[i] != 0) printf(" %s %.1f%%", names[i], evtrace_cycles[i] * 100.0 / total);
+    }
+    printf("\n");
+}
+
+// the firmware's run-time counters (perf.c) since BIOS_start()
+static void perf_report_line(void)
+{
+    perf_tick(); // copies spi_byte_count
+    printf("counters       %lu samples, %lu overruns, %lu posts, %lu conversions, %lu draws, %lu redraws, %lu clears\n",
+           (unsigned long)perf.samples, (unsigned long)perf.sci_overruns, (unsigned long)perf.swi_posts,
+           (unsigned long)perf.conversions, (unsigned long)perf.draws, (unsigned long)perf.redraws,
+           (unsigned long)perf.clears);
+    printf("               %lu spi bytes, %lu commands, lock_Sem waited %lu times for %.3f ms (max %.3f ms), "
+           "%lu bins dropped in %lu sweeps\n",
+           (unsigned long)perf.spi_bytes, (unsigned long)perf.spi_commands, (unsigned long)perf.lock_waits,
+           perf.lock_wait * 1e3 / BIOS_HOST_CPU_HZ, perf.lock_wait_max * 1e3 / BIOS_HOST_CPU_HZ,
+           (unsigned long)perf.dropped_bins, (unsigned long)perf.dropped_sweeps);
+}
+
+// the idle thread sends a trace into "file", as if "flag" was set in the debugger
+static int dump_trace(const char *file, int16 *flag, double tick)
+{
+    hal_sci_out = fopen(file, "wb");
+    if (hal_sci_out == NULL) {
+        perror(file);
+        return 1;
+    }
+    *flag = 1;
+    bios_host_run(bios_host_cycles + (unsigned long long)tick);
+    fclose(hal_sci_out);
+    hal_sci_out = NULL;
+    return 0;
+}
+
+// drop -G and -W from the arguments, what is left reproduces the run (returns the new argc)
+static int args(int argc, char **argv)
+{
+    int i, n = 0;
+
+    for (i = 0; i < argc; i++) {
+        if ((strcmp(argv[i], "-G") == 0) || (strcmp(argv[i], "-W") == 0)) {
+            i++;
+        } else if ((strncmp(argv[i], "-G", 2) != 0) && (strncmp(argv[i], "-W", 2) != 0)) {
+            argv[n++] = argv[i];
+        }
+    }
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long seed = 0;
+    const char *ppm = NULL;
+    const char *replay = NULL;
+    const char *dump = NULL;
+    const char *events = NULL;
+    const char *scene_file = NULL;
+    const char *ramp_arg = NULL;
+    const char *golden_check = NULL;
+    const char *golden_out = NULL;
+    const char *panel = NULL;
+    struct load_result r;
+    unsigned long long start, end;
+    double tick, sweeps;
+    int opt, wrong, failed;
+    FILE *out;
+
+    while ((opt = getopt(argc, argv, "s:r:e:f:g:m:z:S:j:C:o:R:T:E:L:G:W:BP:")) != -1) {
+        switch (opt) {
+        case 's': load.revs = atoi(optarg); break;
+        case 'r': load.rpm = atof(optarg); break;
+        case 'e': load.counts = atof(optarg); break;
+        case 'f': load.rate = atof(optarg); break;
+        case 'g': scene_file = optarg; break;
+        case 'm': display_mode = atoi(optarg); break;
+        case 'z': zoom_select = atoi(optarg); break;
+        case 'S': seed = strtoul(optarg, NULL, 0); break;
+        case 'j': bios_host_jitter = (unsigned long)(atof(optarg) * BIOS_HOST_CPU_HZ / 1e6); break;
+        case 'C': set_cost(optarg); break;
+        case 'o': ppm = optarg; break;
+        case 'R': replay = optarg; break;
+        case 'T': dump = optarg; break;
+        case 'E': events = optarg; break;
+        case 'L': ramp_arg = optarg; break;
+        case 'G': golden_check = optarg; break;
+        case 'W': golden_out = optarg; break;
+        case 'B': hal_selftest_pin = 1; break;
+        case 'P': panel = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+    if ((load.revs < 1) || (load.rpm <= 0) || (load.counts < 1) || (load.rate < 0)) usage(argv[0]);
+    if ((panel != NULL) && (select_panel(panel) != 0)) return 1;
+    if ((replay != NULL) && (replay_load(replay) != 0)) return 1;
+    if ((golden_check != NULL) && (golden_load(golden_check) != 0)) return 1;
+    golden = (golden_check != NULL) || (golden_out != NULL);
+    if (scene_file == NULL) {
+        scene_default(&scene);
+    } else if (scene_load(&scene, scene_file) != 0) {
+        return 1;
+    }
+    bios_host_seed(seed);
+    if ((seed == 0) && (bios_host_jitter != 0)) bios_host_seed(1);
+    if (ramp_arg != NULL) return ramp(ramp_arg);
+
+    vpanel_reset();
+    if (hal_selftest_pin) hal_sci_out = stdout;
+    firmware_main();    // set up, draw the background and create the threads
+    hal_sci_out = NULL;
+    bios_host_run(bios_host_cycles); // tasks run until they pend
+    printf("startup\n");
+    vpanel_print(stdout);
+
+    tick = BIOS_HOST_CPU_HZ * 60.0 / load.rpm / load.counts;
+    if (replay != NULL) {
+        mySwi->stats.deadline = (unsigned long long)tick;
+        draw_point->stats.deadline = (unsigned long long)tick;
+        clear_point->stats.deadline = (unsigned long long)tick;
+        redraw_point->stats.deadline = (unsigned long long)tick;
+        vpanel_reset_counts();
+        cost_reset();
+        start = bios_host_cycles;
+        // one more tick after the last record to finish its work
+        end = replay_start(start) + (unsigned long long)tick;
+        bios_host_run(end);
+        printf("replayed %s: %lu encoder, %lu IR, %lu samples over %.3f ms\n", replay, replay_counts.encoder,
+               replay_counts.ir, replay_counts.samples, (end - start) * 1e3 / BIOS_HOST_CPU_HZ);
+        vpanel_print(stdout);
+        sweeps = (end - start) / (tick * load.counts);
+    } else {
+        run_load(&r);
+        printf("%d sweeps at %.0f rpm, %lu samples, %lu dropped by the scene, clear task up to %d bins behind\n",
+               load.revs, load.rpm, r.samples, workload_stats.dropouts, r.max_lag);
+        vpanel_print(stdout);
+        printf("per sweep      %lu bytes, %.3f ms on the wire\n", r.bytes, vpanel_wire_ns() / 1e6 / load.revs);
+        sweeps = load.revs;
+    }
+    printf("sci bytes lost %lu\n", sim_sci_lost);
+    bios_host_report(stdout);
+    evtrace_report();
+    latency_update();
+    printf("sample->pixel  %lu samples shown, p50 %lu us, p99 %lu us, max %lu us (SCI read to RAMWR)\n",
+           (unsigned long)latency_count, (unsigned long)latency_p50, (unsigned long)latency_p99,
+           (unsigned long)latency_max);
+    perf_report_line();
+    cost_report(stdout, sweeps);
+    wrong = sim_check_screen(stdout);
+    printf("screen check   %d wrong pixels\n", wrong);
+    printf("frame hash     %08lx\n", vpanel_hash(_width, _height));
+    failed = golden_finish(stdout, wrong, sim_sci_lost);
+    if ((golden_out != NULL) && ((wrong != 0) || (sim_sci_lost != 0))) {
+        fprintf(stderr, "%s: not written, %d wrong pixels and %lu sci bytes lost\n", golden_out, wrong, sim_sci_lost);
+        return 1;
+    }
+    if ((golden_out != NULL) && (golden_write(golden_out, args(argc, argv), argv) != 0)) return 1;
+
+    if ((dump != NULL) && (dump_trace(dump, &trace_dump, tick) != 0)) return 1;
+    if ((events != NULL) && (dump_trace(events, &evtrace_dump, tick) != 0)) return 1;
+
+    if (ppm != NULL) {
+        out = fopen(ppm, "wb");
+        if ((out == NULL) || (vpanel_write_ppm(out, _width, _height) != 0)) {
+            perror(ppm);
+            return 1;
+        }
+        fclose(out);
+    }
+    return (failed || (wrong != 0)) ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+// vpanel.c
+// Author: Joseph Dobrzanski
+// Virtual ST7735: command/data decoder, display RAM and wire-time model.
+// Only the commands spi_screen.c sends are decoded; the others are counted.
+
+#include <string.h>
+#include "hal.h"
+#include "spi_screen.h"
+#include "vpanel.h"
+#include "display_mem.h"
+
+struct vpanel_stats vpanel_stats;
+Uint16 vpanel_ram[VPANEL_ROWS][VPANEL_COLS];
+
+static Uint16 command;          // last command byte
+static Uint16 param;            // data bytes received since the command
+static Uint16 word;             // first byte of a 16-bit parameter or pixel
+static int16 col_start, col_end, row_start, row_end;
+static int16 col, row;          // RAMWR cursor
+static int16 scroll_top, scroll_rows, scroll_line;
+
+void vpanel_reset(void)
+{
+    memset(&vpanel_stats, 0, sizeof(vpanel_stats));
+    memset(vpanel_ram, 0, sizeof(vpanel_ram));
+    command = 0;
+    param = 0;
+    col_start = row_start = 0;
+    col_end = VPANEL_COLS - 1;
+    row_end = VPANEL_ROWS - 1;
+    col = row = 0;
+    scroll_top = 0;
+    scroll_rows = VPANEL_ROWS;
+    scroll_line = 0;
+}
+
+// start counting again, the display RAM and decoder state are kept
+void vpanel_reset_counts(void)
+{
+    memset(&vpanel_stats, 0, sizeof(vpanel_stats));
+}
+
+static void write_pixel(Uint16 color)
+{
+    if ((col < VPANEL_COLS) && (row < VPANEL_ROWS)) {
+        vpanel_ram[row][col] = color;
+        vpanel_stats.pixels++;
+    } else {
+        vpanel_stats.clipped++;
+    }
+    // the cursor wraps inside the window like the panel's
+    if (++col > col_end) {
+        col = col_start;
+        if (++row > row_end) row = row_start;
+    }
+}
+
+void vpanel_byte(Uint16 dc, Uint16 data)
+{
+    vpanel_stats.bytes++;
+    if (dc == 0) {
+        command = data;
+        param = 0;
+        vpanel_stats.commands++;
+        vpanel_stats.by_command[data]++;
+        if (data == RAMWR) {
+            vpanel_stats.windows++;
+            col = col_start;
+            row = row_start;
+        }
+        return;
+    }
+
+    if ((param & 1) == 0) {
+        word = data << 8;
+    } else {
+        word |= data;
+        switch (command) {
+        case CASET:
+            if (param == 1) col_start = word; else if (param == 3) col_end = word;
+            break;
+        case RASET:
+            if (param == 1) row_start = word; else if (param == 3) row_end = word;
+            break;
+        case RAMWR:
+            write_pixel(word);
+            break;
+        case VSCRDEF:
+            if (param == 1) scroll_top = word; else if (param == 3) scroll_rows = word;
+            break;
+        case VSCSAD:
+            scroll_line = word;
+            break;
+        }
+    }
+    param++;
+}
+
+// time the bytes take on the SPI wire
+unsigned long long vpanel_wire_ns(void)
+{
+    return (unsigned long long)vpanel_stats.bytes * 8 * 1000000000ULL / VPANEL_SPI_HZ;
+}
+
+// color shown at (x, y), following the vertical scroll like the panel (read from the
+// framebuffer when the memory backend is selected, sim -P)
+Uint16 vpanel_pixel(int16 x, int16 y)
+{
+    int16 ram_row = y;
+
+    if (display == &display_mem) return display_mem_pixel(x, y);
+
+    if ((scroll_rows > 0) && (y >= scroll_top) && (y < scroll_top + scroll_rows)) {
+        ram_row = scroll_top + (y - scroll_top + scroll_line - scroll_top + scroll_rows) % scroll_rows;
+    }
+    if ((x < 0) || (x >= VPANEL_COLS) || (ram_row < 0) || (ram_row >= VPANEL_ROWS)) return 0;
+    return vpanel_ram[ram_row][x];
+}
+
+// FNV-1a over the visible pixels
+unsigned long vpanel_hash(int16 width, int16 height)
+{
+    Uint32 hash = 2166136261UL;
+    int16 x, y;
+    Uint16 color;
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            color = vpanel_pixel(x, y);
+            hash = (hash ^ (color >> 8)) * 16777619UL;
+            hash = (hash ^ (color & 0xFF)) * 16777619UL;
+        }
+    }
+    return hash;
+}
+
+int vpanel_write_ppm(FILE *out, int16 width, int16 height)
+{
+    int16 x, y;
+    Uint16 color;
+
+    fprintf(out, "P6\n%d %d\n255\n", width, height);
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            color = vpanel_pixel(x, y);
+            fputc(((color >> 11) & 0x1F) * 255 / 31, out);
+            fputc(((color >> 5) & 0x3F) * 255 / 63, out);
+            fputc((color & 0x1F) * 255 / 31, out);
+        }
+    }
+    return ferror(out) ? -1 : 0;
+}
+
+void vpanel_print(FILE *out)
+{
+    fprintf(out, "spi bytes      %lu\n", vpanel_stats.bytes);
+    fprintf(out, "commands       %lu (CASET %lu, RASET %lu, RAMWR %lu, VSCSAD %lu)\n",
+            vpanel_stats.commands, vpanel_stats.by_command[CASET], vpanel_stats.by_command[RASET],
+            vpanel_stats.by_command[RAMWR], vpanel_stats.by_command[VSCSAD]);
+    fprintf(out, "pixels         %lu (%lu outside display RAM)\n", vpanel_stats.pixels, vpanel_stats.clipped);
+    fprintf(out, "wire time      %.3f ms\n", vpanel_wire_ns() / 1e6);
+}
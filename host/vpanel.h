@@ -0,0 +1,37 @@
+// vpanel.h
+// Author: Joseph Dobrzanski
+// Virtual ST7735 for the host build. Decodes the byte stream sent on SPIA
+// (CASET/RASET/RAMWR/VSCRDEF/VSCSAD) into a display RAM and counts what it
+// would cost on the wire.
+
+#ifndef VPANEL_H
+#define VPANEL_H
+
+#include <stdio.h>
+
+#define VPANEL_COLS     132     // ST7735 display RAM
+#define VPANEL_ROWS     162
+#define VPANEL_SPI_HZ   500000L     // SPI_BRR in DeviceInit_18Nov2018.c
+
+struct vpanel_stats {
+    unsigned long bytes;            // bytes on the wire (commands and data)
+    unsigned long commands;         // command bytes
+    unsigned long windows;          // RAMWR commands
+    unsigned long pixels;           // pixels written to display RAM
+    unsigned long clipped;          // pixels outside the display RAM
+    unsigned long by_command[256];  // command bytes by opcode
+};
+
+extern struct vpanel_stats vpanel_stats;
+extern Uint16 vpanel_ram[VPANEL_ROWS][VPANEL_COLS];
+
+void vpanel_reset(void);
+void vpanel_reset_counts(void);
+void vpanel_byte(Uint16 dc, Uint16 data);
+unsigned long long vpanel_wire_ns(void);
+Uint16 vpanel_pixel(int16 x, int16 y);
+unsigned long vpanel_hash(int16 width, int16 height);
+int vpanel_write_ppm(FILE *out, int16 width, int16 height);
+void vpanel_print(FILE *out);
+
+#endif
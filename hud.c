@@ -0,0 +1,81 @@
+// hud.c
+// Author: Joseph Dobrzanski
+// Numeric HUD readouts. hud_set() only stores the value (no SPI, safe from any
+// thread); hud_tick() repaints at most one changed digit per call, and only
+// while the tick's SPI budget is not spent, so the HUD costs one glyph blit
+// (~81 bytes) per encoder tick at worst and nothing when the values are steady.
+// Labels are drawn once by hud_init().
+// hud_init() and hud_tick() write to the screen: call them with lock_Sem held
+// (or before BIOS_start()).
+
+#include "hud.h"
+#include "layers.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+static const char hud_labels[NUM_READOUTS] = {'R', 'B', 'N', 'C'};
+
+static int16 hud_value[NUM_READOUTS];                 // value to show
+static char hud_shown[NUM_READOUTS][HUD_DIGITS];      // characters on the screen
+static int16 hud_next = 0;                            // readout to check first on the next tick
+
+// character of digit "place" (0 = left) of value, right-aligned with leading blanks
+static char digit_char(int16 value, int16 place)
+{
+    int16 power = HUD_DIGITS - 1 - place;
+
+    HAL_COST(COST_CYCLES, 12);
+    while (power-- > 0) {
+        HAL_COST(COST_DIV16, 1);
+        HAL_COST(COST_CYCLES, 6);
+        value /= 10;
+        if (value == 0) return ' ';
+    }
+    HAL_COST(COST_DIV16, 1);
+    return '0' + (value % 10);
+}
+
+void hud_init(void)
+{
+    int16 readout, place;
+    for (readout = 0; readout < NUM_READOUTS; readout++) {
+        const struct hud_region *hud = &hud_regions[readout];
+        _writeCharacter(hud_labels[readout], hud->x, hud->y + 1, HUD_COLOR, HUD_TEXT_COLOR, 1);
+        hud_value[readout] = 0;
+        for (place = 0; place < HUD_DIGITS; place++) {
+            hud_shown[readout][place] = ' '; // boxes start out blank (layers_draw)
+        }
+    }
+}
+
+void hud_set(int16 readout, int16 value)
+{
+    if (value < 0) value = 0;
+    if (value > 999) value = 999;
+    hud_value[readout] = value;
+}
+
+// repaint the first digit that changed (readouts are checked round-robin), unless "budget" is spent
+void hud_tick(Uint16 budget)
+{
+    int16 count, readout, place;
+    char c;
+
+    if (budget == 0) return;
+    for (count = 0; count < NUM_READOUTS; count++) {
+        readout = hud_next;
+        hud_next = (hud_next + 1) % NUM_READOUTS;
+        HAL_COST(COST_CYCLES, 10);  // NUM_READOUTS is a power of two
+        for (place = 0; place < HUD_DIGITS; place++) {
+            HAL_COST(COST_CYCLES, 10);
+            c = digit_char(hud_value[readout], place);
+            if (c != hud_shown[readout][place]) {
+                const struct hud_region *hud = &hud_regions[readout];
+                _writeCharacter(c, hud->x + (place + 1)*HUD_PITCH, hud->y + 1, HUD_COLOR, HUD_TEXT_COLOR, 1);
+                hud_shown[readout][place] = c;
+                hud_next = readout; // finish this readout first
+                return;
+            }
+        }
+    }
+}
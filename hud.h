@@ -0,0 +1,29 @@
+// hud.h
+// Author: Joseph Dobrzanski
+// Numeric HUD readouts (range, bearing, RPM, CPU load) in the corner boxes of
+// layers.c. Only digits that changed are repainted.
+
+#ifndef HUD_H
+#define HUD_H
+
+#include "main_file.h"
+
+#define HUD_TEXT_COLOR  0x07E0  // green on the black HUD boxes
+#define HUD_DIGITS      3       // digits per readout (values are clamped to 0..999)
+#define HUD_PITCH       (FONT_W + 1)    // one spacing column between characters
+
+// readouts, one per HUD box (same order as hud_regions[])
+#define HUD_RANGE       0       // 'R' last distance sample
+#define HUD_BEARING     1       // 'B' bearing of the sweep (degrees)
+#define HUD_RPM         2       // 'N' motor speed (rev/min)
+#define HUD_CPU         3       // 'C' CPU load (%)
+#define NUM_READOUTS    4
+
+#define HUD_BEARING_BINS 15     // the bearing readout moves in steps of this many bins (24 degrees),
+                                // so it does not repaint a digit on every encoder tick
+
+void hud_init(void);
+void hud_set(int16 readout, int16 value);
+void hud_tick(Uint16 budget);
+
+#endif
@@ -0,0 +1,193 @@
+// latency.c
+// Author: Joseph Dobrzanski
+// The tag follows the sample the way its distance does: latency_sample() stamps
+// it next to "distance" in the idle thread, the Swi hands the stamp to the draw
+// and redraw tasks with the point (latency_queue()), and the task records the
+// delay once render_owner_change() has sent the pixel (latency_shown()). Like
+// the point itself there is one stamp in flight; while it is pending, newer
+// samples keep the older stamp, so a backlog shows up as a longer delay.
+
+#include "latency.h"
+#include "trace.h"
+#include "evtrace.h"
+#include "hal.h"
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+
+#if DIAG_BUILD
+Uint16 latency_hist[LATENCY_BINS];
+#endif
+Uint32 latency_count = 0;
+Uint32 latency_p50 = 0;
+Uint32 latency_p99 = 0;
+Uint32 latency_max = 0;
+int16 latency_report = 0;
+int16 latency_clear = 0;
+
+static Uint32 per_us = 60;          // Timestamp counts per microsecond
+static Uint32 sample_time = 0;      // stamp of the distance in "distance"
+static Uint32 queued_time = 0;      // stamp of the point handed to a task
+static int16 queued = 0;
+static Uint32 max_units = 0;
+static Uint16 updated_sweep = 0;
+static char text[LATENCY_TEXT];
+static Uint16 text_pos = 0;         // next character sent, text[] is empty when it is on the 0
+
+void latency_init(Uint32 freq)
+{
+    per_us = freq / 1000000;
+    if (per_us == 0) per_us = 1;
+}
+
+// idle thread: a distance was just taken out of the SCI receive FIFO
+void latency_sample(void)
+{
+    sample_time = Timestamp_get32();
+}
+
+// Swi: the sample's point was handed to the draw or redraw task
+void latency_queue(void)
+{
+    if (!queued) {
+        queued_time = sample_time;
+        queued = 1;
+    }
+}
+
+#if DIAG_BUILD
+static Uint16 bin_of(Uint32 units)
+{
+    Uint16 e = 0;
+
+    if (units < 4) return (Uint16)units;
+    while ((units >> e) >= 8) e++;  // units >> e is 4..7
+    if (e >= LATENCY_BINS / 4 - 1) return LATENCY_BINS - 1;
+    return (e + 1) * 4 + (Uint16)(units >> e) - 4;
+}
+
+// upper edge of bin "b" in histogram units
+static Uint32 bin_top(Uint16 b)
+{
+    if (b < 4) return b + 1;
+    return (Uint32)(b % 4 + 5) << (b / 4 - 1);
+}
+#endif
+
+// task: the point has been written to the screen ("drawn" = 0 if the view is not showing it)
+void latency_shown(int16 drawn)
+{
+    Uint32 units;
+#if DIAG_BUILD
+    Uint16 b, i;
+#endif
+
+    if (!queued) return;
+    queued = 0;
+    if (!drawn) return;
+    units = (Timestamp_get32() - queued_time) >> LATENCY_SHIFT;
+    if (units > (1UL << 21)) units = 1UL << 21;
+    if (units > max_units) max_units = units;
+#if DIAG_BUILD
+    b = bin_of(units);
+    if (latency_hist[b] == 0xFFFF) {
+        for (i = 0; i < LATENCY_BINS; i++) latency_hist[i] >>= 1;
+    }
+    latency_hist[b]++;
+#endif
+    latency_count++;
+}
+
+static Uint32 to_us(Uint32 units)
+{
+    return (units << LATENCY_SHIFT) / per_us;
+}
+
+// p50, p99 and max from the histogram (only the max without DIAG_BUILD)
+void latency_update(void)
+{
+#if DIAG_BUILD
+    Uint32 total = 0, sum = 0;
+    Uint16 b;
+
+    for (b = 0; b < LATENCY_BINS; b++) total += latency_hist[b];
+    latency_p50 = latency_p99 = 0;
+    for (b = 0; (b < LATENCY_BINS) && (total != 0); b++) {
+        sum += latency_hist[b];
+        if ((latency_p50 == 0) && (sum * 2 >= total)) latency_p50 = to_us(bin_top(b));
+        if (sum * 100 >= total * 99) {
+            latency_p99 = to_us(bin_top(b));
+            break;
+        }
+    }
+#endif
+    latency_max = to_us(max_units);
+    if (latency_p50 > latency_max) latency_p50 = latency_max; // the top bin is a bound, the max is exact
+    if (latency_p99 > latency_max) latency_p99 = latency_max;
+}
+
+static Uint16 append_text(Uint16 length, const char *s)
+{
+    while (*s && (length < LATENCY_TEXT - 1)) text[length++] = *s++;
+    return length;
+}
+
+static Uint16 append_number(Uint16 length, Uint32 value)
+{
+    char digits[11];
+    int16 count = 0;
+
+    do {
+        digits[count++] = '0' + (char)(value % 10);
+        value /= 10;
+    } while (value != 0);
+    while ((count > 0) && (length < LATENCY_TEXT - 1)) text[length++] = digits[--count];
+    return length;
+}
+
+// call from the idle thread: refreshes the figures each sweep and sends the report line when "latency_report" is set
+void latency_tick(void)
+{
+    Uint16 length;
+#if DIAG_BUILD
+    Uint16 i;
+#endif
+
+    if (latency_clear) {
+#if DIAG_BUILD
+        for (i = 0; i < LATENCY_BINS; i++) latency_hist[i] = 0;
+#endif
+        latency_count = 0;
+        max_units = 0;
+        latency_clear = 0;
+        latency_update();
+    }
+    if (updated_sweep != sweep_count) {
+        updated_sweep = sweep_count;
+        latency_update();
+    }
+    if (!latency_report || trace_dump || evtrace_dump) return;
+    if (text_pos == 0) {
+        latency_update();
+        length = append_text(0, "latency n ");
+        length = append_number(length, latency_count);
+#if DIAG_BUILD
+        length = append_text(length, " p50 ");
+        length = append_number(length, latency_p50);
+        length = append_text(length, " us p99 ");
+        length = append_number(length, latency_p99);
+        length = append_text(length, " us");
+#endif
+        length = append_text(length, " max ");
+        length = append_number(length, latency_max);
+        length = append_text(length, " us\r\n");
+        text[length] = 0;
+    }
+    while (text[text_pos] && HAL_SCI_TX_READY()) {
+        HAL_SCI_TX_BYTE(text[text_pos]);
+        text_pos++;
+    }
+    if (!text[text_pos]) {
+        text_pos = 0;
+        latency_report = 0;
+    }
+}
@@ -0,0 +1,41 @@
+// latency.h
+// Author: Joseph Dobrzanski
+// Sample-to-photon latency: the time from the idle thread taking a distance out
+// of the SCI receive FIFO to the end of the RAMWR that puts its point on the
+// screen. The delays go into a histogram with four bins per octave (at most
+// 25% too high), and p50, p99 and the maximum are worked out from it once per
+// sweep. Setting "latency_report" sends them over SCI TX as one line of text:
+//   latency n 812 p50 1520 us p99 9730 us max 9914 us
+// Samples that only confirm the pixel already on screen (delta_hysteresis) do
+// not change the screen and are not counted. The FIFO is only read when the
+// idle thread runs, so time a byte spends waiting in it is not included; a
+// busy system shows up as lost SCI bytes instead. The count and the maximum are
+// in every build; the histogram (80 words) and p50/p99 only with DIAG_BUILD
+// (main_file.h), and without it the line has no p50 and p99:
+//   latency n 812 max 9914 us
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "main_file.h"
+
+#define LATENCY_SHIFT   6       // histogram unit is 64 Timestamp counts (1.07 us at 60 MHz)
+#define LATENCY_BINS    80      // 0..3 units, then 4 bins per octave up to 2^21 units (2.2 s at 60 MHz)
+#define LATENCY_TEXT    64      // longest report line
+
+extern Uint16 latency_hist[LATENCY_BINS];  // counts, halved when one of them would overflow (DIAG_BUILD only)
+extern Uint32 latency_count;    // samples shown since boot
+extern Uint32 latency_p50;      // us, updated once per sweep (0 without DIAG_BUILD)
+extern Uint32 latency_p99;      // us (0 without DIAG_BUILD)
+extern Uint32 latency_max;      // us, largest single delay since boot (or since latency_clear)
+extern int16 latency_report;    // set to 1 through the "Expressions" watch list to send the line, back to 0 when sent
+extern int16 latency_clear;     // set to 1 through the "Expressions" watch list to empty the histogram
+
+void latency_init(Uint32 freq);
+void latency_sample(void);
+void latency_queue(void);
+void latency_shown(int16 drawn);
+void latency_update(void);
+void latency_tick(void);
+
+#endif
@@ -0,0 +1,81 @@
+// layers.c
+// Author: Joseph Dobrzanski
+// Procedural background of the sonar display. Layers from top to bottom:
+// HUD boxes, the sweep line (sweep_line.c), the area outside the disc, the rim, range rings, bearing spokes
+// (every 45 degrees) and the disc itself (BACKGROUND_COLOR).
+
+#include "layers.h"
+#include "sweep_line.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+#define HUD_W   24
+#define HUD_H   9
+
+// HUD boxes in the four corners of the panel (outside the disc)
+struct hud_region hud_regions[NUM_HUD_REGIONS];
+
+// background color of pixel (x, y)
+int layer_color(int16 x, int16 y)
+{
+    int16 dx = x - DISC_X;
+    int16 dy = y - DISC_Y;
+    int32 dist;
+    int16 ring;
+    int index;
+
+    HAL_COST(COST_CYCLES, 20);
+    for (index = 0; index < NUM_HUD_REGIONS; index++) {
+        const struct hud_region *hud = &hud_regions[index];
+        HAL_COST(COST_CYCLES, 12);
+        if ((x >= hud->x) && (x < hud->x + hud->w) && (y >= hud->y) && (y < hud->y + hud->h)) {
+            return HUD_COLOR;
+        }
+    }
+    if (sweep_line_covers(x, y)) {
+        return SWEEP_COLOR;
+    }
+
+    dist = (int32)dx*dx + (int32)dy*dy;
+    HAL_COST(COST_CYCLES, 15);
+    if (dist > (int32)DISC_R*DISC_R) {
+        return OUTSIDE_COLOR;
+    }
+    if (dist >= (int32)(DISC_R - RIM_WIDTH)*(DISC_R - RIM_WIDTH)) {
+        return RIM_COLOR;
+    }
+
+    // pixel lies on ring k if round(sqrt(dist)) == k, i.e. k*k - k < dist <= k*k + k
+    for (ring = RING_STEP; ring < DISC_R - RIM_WIDTH; ring += RING_STEP) {
+        HAL_COST(COST_CYCLES, 14);
+        if ((dist > (int32)ring*ring - ring) && (dist <= (int32)ring*ring + ring)) {
+            return GRID_COLOR;
+        }
+    }
+
+    if ((dx == 0) || (dy == 0) || (dx == dy) || (dx == -dy)) {
+        return GRID_COLOR;
+    }
+    return BACKGROUND_COLOR;
+}
+
+// paint the whole background in one address window (replaces fillScreen + drawCircle)
+void layers_draw(void)
+{
+    int16 x, y, index;
+
+    for (index = 0; index < NUM_HUD_REGIONS; index++) {
+        hud_regions[index].x = (index & 1) ? _width - HUD_W : 0;
+        hud_regions[index].y = (index & 2) ? _height - HUD_H : 0;
+        hud_regions[index].w = HUD_W;
+        hud_regions[index].h = HUD_H;
+    }
+
+    _startWrite(0, 0, _width - 1, _height - 1);
+    for (y = 0; y < _height; y++) {
+        for (x = 0; x < _width; x++) {
+            HAL_COST(COST_CYCLES, 6);
+            _pushColor(layer_color(x, y));
+        }
+    }
+}
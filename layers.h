@@ -0,0 +1,35 @@
+// layers.h
+// Author: Joseph Dobrzanski
+// Procedural background of the sonar display (HUD boxes, rim, range rings,
+// bearing spokes). Any pixel's background color can be worked out with a few
+// integer tests, so erasing a point restores what was underneath it without
+// keeping a copy of the screen.
+
+#ifndef LAYERS_H
+#define LAYERS_H
+
+#include "main_file.h"
+#include "spi_screen.h"
+
+#define DISC_X          (_width/2)      // center of the sonar disc
+#define DISC_Y          (_height/2)
+#define DISC_R          (((_width < _height) ? _width : _height)/2) // outer radius of the disc (pixels)
+#define RIM_WIDTH       2       // rim drawn on the inside of the disc edge
+#define RING_STEP       16      // range ring every RING_STEP pixels
+
+#define OUTSIDE_COLOR   0x0000  // panel around the disc
+#define RIM_COLOR       0x03E0  // dark green
+#define GRID_COLOR      0x9FF3  // pale green range rings and bearing spokes
+#define HUD_COLOR       0x0000  // behind HUD readouts
+
+struct hud_region {
+    int16 x, y, w, h;
+};
+
+#define NUM_HUD_REGIONS 4
+extern struct hud_region hud_regions[NUM_HUD_REGIONS]; // set up by layers_draw() for the panel size
+
+int layer_color(int16 x, int16 y);
+void layers_draw(void);
+
+#endif
@@ -6,54 +6,79 @@
 #define xdc__strict //gets rid of #303-D typedef warning re Uint16, Uint32
 
 #include "Peripheral_Headers/F2802x_Device.h"
+#include "hal.h"
 #include "spi_screen.h"
+#include "main_file.h"
+#include "sweep_history.h"
+#include "render.h"
+#include "layers.h"
+#include "sweep_line.h"
+#include "hud.h"
+#include "contour.h"
+#include "phosphor.h"
+#include "bscan.h"
+#include "waterfall.h"
+#include "coord.h"
+#include "trace.h"
+#include "selftest.h"
+#include "evtrace.h"
+#include "latency.h"
+#include "perf.h"
 #include <xdc/std.h>
 #include <ti/sysbios/BIOS.h>
 #include <ti/sysbios/knl/Swi.h>
 #include <ti/sysbios/knl/Task.h>
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/utils/Load.h>
+#include <xdc/runtime/Timestamp.h>
 
-// values for encoder (angle) things
-#define ENCODER_ANG 16       // number of degrees expected from each pulse of the encoder: 224.4count/rev -> 360deg/rev * SF
-#define SF  10               // scale factor (to get around floating point numbers)
-#define MAX_ANG  360         // maximum angle in circle (360 degrees)
-
-#define BACKGROUND_COLOR 0xFFFF
-#define TARGET_COLOR 0x0000
+// values for encoder (angle) things are in main_file.h
 
 int32 angle = 0;
 int32 last_points_angle = 360;
-int32 ref_ang = 0;
 int16 distance = 0;
 
 // TEST VARIABLE THINGS
 #define TEST_DEFAULT 100
 int16 test_distance = 0;
 
-// values for sine and cosine approximation
-Uint32 temp_val = 0; // used for intermediate steps
-int32 x_=0;
-int32 y_=0;
-int16 quadrant = 0;
+// values for the coordinate conversion (sine and cosine approximation in coord.c)
 int16 x_coord = 0;
 int16 y_coord = 0;
-int16 x_quadrant_corr = 0;
-int16 y_quadrant_corr = 0;
 
 // value for getting CPU utilization data
 Uint32 CPU_data;
 
-// values for detected points on screen
-#define NUM_POINTS 230
-#define NO_ANG_DATA -1
+// values for measuring motor speed (HUD)
+Uint32 timestamp_freq = 0;  // Timestamp counts per second
+Uint32 sweep_start = 0;     // Timestamp when the current sweep began
+Uint32 sweep_period = 0;    // Timestamp counts taken by the last sweep
+Uint16 tick_budget = TICK_BUDGET; // SPI bytes per encoder tick at the speed of the last sweep (see TICK_BUDGET)
+
+// values for detected points on screen (NUM_POINTS, NO_ANG_DATA in main_file.h)
 int16 points[NUM_POINTS][2] = {}; // about 950 the limit uint8_t
 int16 points_angle[NUM_POINTS];
 int16 array_index = 0;
+int16 draw_index = 0; // bin of the sample the SWI converted last (the encoder HWI can move array_index before the draw TSK runs)
 
 int16 clear_index = 0;
 //int16 last_array_index = 0;
 int16 last_point[2] = {};
+int16 last_point_valid = 0; // last_point is from an earlier sweep and still on screen
+
+// values for the sweep history (aged persistence)
+Uint16 sweep_count = 0;     // completed sweeps, used to age the ghosts in sweep_history.c
+int16 sweep_bins = NUM_BINS; // bins in the last sweep (array_index when the encoder or IR pulse reset it)
+Uint16 fresh_bins[(NUM_POINTS + 15) / 16] = {}; // bins that got a new point during this sweep (FRESH_BIT in main_file.h)
+
+// values for delta rendering
+#define DELTA_HYSTERESIS 1  // moves of up to this many pixels (in x and y) keep the old pixel
+#define DELTA_HYSTERESIS_MAX 3  // larger values set through the watch list are used as this
+int16 delta_hysteresis = DELTA_HYSTERESIS; // can be changed through the "Expressions" watch list (0 = only skip identical pixels)
+
+// values for the display mode (DISPLAY_* in main_file.h)
+int16 display_mode = DISPLAY_POLAR; // can be changed through the "Expressions" watch list
+int16 shown_mode = DISPLAY_POLAR;   // view on the screen, follows display_mode at the next encoder tick
 
 /* Swi handle defined in main_file.cfg */
 extern const Swi_Handle mySwi;
@@ -66,20 +91,38 @@ extern const Semaphore_Handle redraw_Sem;
 
 //function prototypes:
 extern void DeviceInit(void);
+static void switch_mode_Fxn(void);
 
 // MAIN FUNCTION (Initial setup things)
 Int main()
 {
     DeviceInit(); //initialize peripherals
+    if (display_select(display) != 0) { // the driver selected before main() (host/sim -P), DISPLAY_DRIVER by default
+        display_select(&DISPLAY_DRIVER); // it does not fit the buffers (display.h)
+    }
     screen_begin(); // configure screen
+    if (HAL_SELFTEST_PIN()) {
+        selftest_run(); // S1 held: benchmark and self-test report over SCI TX, then carry on
+    }
 
     int index;// set initial values for angle object array
     for (index = 0; index < NUM_POINTS; index++) {
         points_angle[index] = NO_ANG_DATA;
     }
+    history_init();
+
+    if (display_mode == DISPLAY_POLAR) {
+        layers_draw(); // black panel, white disc with rim, range rings and bearing spokes
+        hud_init();    // readout labels in the corner boxes
+    } else {
+        switch_mode_Fxn(); // draw the B-scan or waterfall now, not on the first tick while the LIDAR streams
+    }
 
-    fillScreen(0x0000); //set black background (red = 0x001F)
-    drawCircle(65,65,0,65,0x0000, 0xFFFF);
+    Types_FreqHz freq;
+    Timestamp_getFreq(&freq);
+    timestamp_freq = freq.lo;
+    evtrace_init(timestamp_freq);
+    latency_init(timestamp_freq);
     BIOS_start();    // start SYS/BIOS
     return(0);
 }
@@ -88,7 +131,7 @@ Int main()
 // IDLE THREAD
 Void myIdleFxn(Void) 
 {
-    GpioDataRegs.GPASET.bit.GPIO7 = 1; // set HIGH to allow for CPU utilization measurement via oscilloscope
+    HAL_CPU_IDLE(); // set HIGH to allow for CPU utilization measurement via oscilloscope
 
     /*
     // TEST: for simulating an inputed distance value inputed through "Expressions" watch list
@@ -101,29 +144,62 @@ Void myIdleFxn(Void)
     */
 
     //while (SciaRegs.SCIFFRX.bit.RXFFST < 1) {}
-    if (!(SciaRegs.SCIFFRX.bit.RXFFST < 1))
+    if (HAL_SCI_RX_READY())
     {
-        distance = SciaRegs.SCIRXBUF.bit.RXDT;
+        distance = HAL_SCI_RX_BYTE();
+        latency_sample();
+        trace_record(TRACE_SAMPLE, distance);
+        PERF_COUNT(samples);
+        PERF_COUNT(swi_posts);
         Swi_post(mySwi);
     }
+    if (HAL_SCI_RX_OVERRUN())
+    {
+        PERF_COUNT(sci_overruns);
+        HAL_SCI_RX_OVERRUN_CLEAR();
+    }
+    trace_dump_tick(); // sends the input trace over SCI TX when "trace_dump" is set
+    evtrace_dump_tick(); // sends the event trace when "evtrace_dump" is set
+    latency_tick(); // p50/p99/max once per sweep, sent over SCI TX when "latency_report" is set
+    perf_tick(); // sends the counters over SCI TX when "perf_report" is set
     CPU_data = Load_getCPULoad();
 }
 
+// start of a new sweep: times the motor and sizes the tick budget for its speed
+static void new_sweep_Fxn(void)
+{
+    Uint32 now = Timestamp_get32();
+    Uint32 fastest = (60*timestamp_freq)/MOTOR_MAX_RPM; // sweep period at MOTOR_MAX_RPM
+    Uint32 budget;
+
+    sweep_period = now - sweep_start;
+    sweep_start = now;
+    if ((array_index > 0) && (array_index <= NUM_POINTS)) sweep_bins = array_index;
+    // the tick budget grows with the length of a tick (in 1/16 steps), once a whole sweep was timed
+    budget = ((fastest >= 16) && (sweep_count != 0)) ? ((Uint32)TICK_BUDGET * (sweep_period / (fastest / 16))) / 16 : TICK_BUDGET;
+    tick_budget = (budget > TICK_BUDGET_MAX) ? TICK_BUDGET_MAX : (Uint16)budget;
+    sweep_count++;
+    perf_sweep_end();
+}
+
 // jd: HWI for incrementing angle
 //      Activates on every motor encoder pulse
 Void encoder_Fxn(Void)
 {
-    GpioDataRegs.GPACLEAR.bit.GPIO7 = 1; // // set LOW to allow for CPU utilization measurement via oscilloscope
+    HAL_CPU_BUSY(); // // set LOW to allow for CPU utilization measurement via oscilloscope
+    trace_record(TRACE_ENCODER, 0);
+    perf_bin_passed(!(fresh_bins[array_index >> 4] & FRESH_BIT(array_index)));
 
     // increment angle
     angle = angle + ENCODER_ANG;
     array_index = (array_index + 1) % NUM_POINTS;
+    HAL_COST(COST_DIV16, 1);
 
     // in case IR LED breaks, system should (in theory) continue to detect objects
     if (angle >= (MAX_ANG*SF)) {
         angle = 0; //angle - (MAX_ANG*SF);
         array_index = 0;
-        clear_index = 0;
+        new_sweep_Fxn();
     }
 
     Semaphore_post(clear_Sem);
@@ -133,55 +209,49 @@ Void encoder_Fxn(Void)
 //      Activates when when IR pulse hit
 Void IR_Fxn(Void)
 {
-    GpioDataRegs.GPACLEAR.bit.GPIO7 = 1; // // set LOW to allow for CPU utilization measurement via oscilloscope
+    HAL_CPU_BUSY(); // // set LOW to allow for CPU utilization measurement via oscilloscope
+    trace_record(TRACE_IR, 0);
+    // only count a sweep once (encoder roll-over may already have reset the angle)
+    if (array_index > NUM_POINTS/2) {
+        new_sweep_Fxn();
+    }
     array_index = 0;
     angle = 0;
-    clear_index = 0;
+    // clear_index is not reset: clear_point_Fxn still has to age the bins at the end of the sweep
+}
+
+// true if the new point (x_coord, y_coord) is within delta_hysteresis pixels of last_point,
+// so redrawing it would only repaint the same pixel or show single-pixel jitter
+static int same_spot_Fxn(void)
+{
+    int16 dx = x_coord - last_point[0];
+    int16 dy = y_coord - last_point[1];
+    int16 hysteresis = delta_hysteresis;
+
+    if (hysteresis < 0) hysteresis = 0;
+    if (hysteresis > DELTA_HYSTERESIS_MAX) hysteresis = DELTA_HYSTERESIS_MAX;
+    if (hysteresis > render_hysteresis) {
+        render_hysteresis = hysteresis; // a held point can now sit further from its bin: widen the owner scan
+    }
+    if (dx < 0) dx = -dx;
+    if (dy < 0) dy = -dy;
+    return (dx <= hysteresis) && (dy <= hysteresis);
 }
 
 // jd: SWI for converting polar coordinates into Cartesian coordinates
 //      Activates when SPI data comes in
 Void polar_to_cart_Fxn(UArg arg)
 {
-    GpioDataRegs.GPACLEAR.bit.GPIO7 = 1; // // set LOW to allow for CPU utilization measurement via oscilloscope
-
-    // find quadrant of angle
-    quadrant = angle/(SF*90);
-
-    // ensure coordinates put into correct quadrant and acquire reference angle
-     if (quadrant == 0) {         // from 0 - 90 degrees
-         x_quadrant_corr = 1;
-         y_quadrant_corr = 1;
-         ref_ang = angle;
-     } else if (quadrant == 1) {  // from 90 - 180 degrees
-         x_quadrant_corr = -1;
-         y_quadrant_corr = 1;
-         ref_ang = SF*180-angle;
-     } else if (quadrant == 2) {  // from 180 - 270 degrees
-         x_quadrant_corr = -1;
-         y_quadrant_corr = -1;
-         ref_ang = angle-SF*180;
-     } else if (quadrant == 3) {  // from 270 - 360 degrees
-         x_quadrant_corr = 1;
-         y_quadrant_corr = -1;
-         ref_ang = SF*360-angle;
-     }
-
-    // calculate y coordinate with sine approximation
-    temp_val = SF*180 - ref_ang;
-    y_ = SF*(Uint32)distance*4*(Uint32)ref_ang*temp_val / (40500*SF*SF-((Uint32)ref_ang)*temp_val); // calculate sine approx
-    y_ = (y_+SF/2)/SF; // round value and scale back down
-
-    // calculate x coordinate with cosine approximation
-    temp_val = (Uint32)ref_ang*(Uint32)ref_ang;
-    x_ = SF*(Uint32)distance - SF*(Uint32)distance*5*temp_val / ((Uint32)32400*SF*SF + temp_val); // calculate cosine approx
-    x_ = (x_ + SF/2)/SF; // round value and scale back down
-
-    // determine coordinate to display coordinates
-    y_coord = _height/2 + y_quadrant_corr*y_;
-    x_coord = _width/2 + x_quadrant_corr*x_;
+    HAL_CPU_BUSY(); // // set LOW to allow for CPU utilization measurement via oscilloscope
+    PERF_COUNT(conversions);
+
+    // polar to screen coordinates at the current zoom (coord.c)
+    coord_project(distance, angle, zoom_scales[zoom_level], &x_coord, &y_coord);
+    // the raw range feeds the B-scan, the waterfall and auto-ranging even when the polar pixel stays
+    coord_store(array_index, distance);
 
     // store prior point in array
+    draw_index = array_index;
     last_point[0] = points[array_index][0];
     last_point[1] = points[array_index][1];
 
@@ -190,31 +260,161 @@ Void polar_to_cart_Fxn(UArg arg)
     // if another point comes in for the same angle measurement, clear prior point before drawing new point.
     if (last_points_angle == angle)
     {
-        Semaphore_post(redraw_Sem);
+        if (same_spot_Fxn())
+        {
+            // jitter only: keep the pixel that is already on screen, no SPI traffic
+            points[array_index][0] = last_point[0];
+            points[array_index][1] = last_point[1];
+        }
+        else
+        {
+            latency_queue();
+            Semaphore_post(redraw_Sem);
+        }
     }
     else
     {
+        // prior point is from an earlier sweep: draw TSK turns it into a ghost if it moved
+        last_point_valid = (points_angle[array_index] != NO_ANG_DATA);
         // store new point in array
         points_angle[array_index] = angle;
-        Semaphore_post(draw_Sem);
+        fresh_bins[array_index >> 4] |= FRESH_BIT(array_index);
+        if (last_point_valid && same_spot_Fxn())
+        {
+            // return did not move since the last sweep: the pixel stays where it is,
+            // but the draw TSK brings it back to full brightness if it has faded (phosphor.c)
+            points[array_index][0] = last_point[0];
+            points[array_index][1] = last_point[1];
+            if (phosphor_aged(array_index) != SHADE_LIVE)
+            {
+                latency_queue();
+                Semaphore_post(draw_Sem);
+            }
+        }
+        else
+        {
+            latency_queue();
+            Semaphore_post(draw_Sem);
+        }
     }
 
     last_points_angle = angle;
 
 }
 
+// pend on lock_Sem, counting the time spent waiting when another task holds it
+static void lock_Fxn(void)
+{
+    Uint32 start;
+
+    if (Semaphore_getCount(lock_Sem) != 0)
+    {
+        Semaphore_pend(lock_Sem, BIOS_WAIT_FOREVER); // free, no wait
+        return;
+    }
+    start = Timestamp_get32();
+    Semaphore_pend(lock_Sem, BIOS_WAIT_FOREVER);
+    perf_lock_waited(Timestamp_get32() - start);
+}
+
+// repaint the screen in display_mode (call with lock_Sem held)
+static void switch_mode_Fxn(void)
+{
+    int16 index;
+
+    if ((display_mode == DISPLAY_WATERFALL) && (display->gram_rows == 0)) {
+        display_mode = shown_mode; // this panel cannot scroll its rows
+        return;
+    }
+    if (shown_mode == DISPLAY_WATERFALL) {
+        waterfall_end();
+    }
+    if (shown_mode == DISPLAY_POLAR) {
+        // the polar view is wiped: its ghosts and contour segments are gone with it
+        history_init();
+        contour_reset();
+    }
+    if (display_mode == DISPLAY_BSCAN) {
+        bscan_draw();
+    } else if (display_mode == DISPLAY_WATERFALL) {
+        waterfall_begin();
+    } else {
+        layers_draw();
+        hud_init();
+        for (index = 0; index < NUM_POINTS; index++) {
+            if (points_angle[index] != NO_ANG_DATA) {
+                render_point(index);
+                contour_point_moved(index, points[index][0], points[index][1]);
+            }
+        }
+    }
+    shown_mode = display_mode;
+}
+
+// move the return and ghosts of a bin drawn with an old zoom level (call with lock_Sem held)
+static void rescale_bin_Fxn(int16 bin)
+{
+    int16 old_x = points[bin][0];
+    int16 old_y = points[bin][1];
+    Uint16 shade;
+
+    coord_rescaled(bin);
+    history_drop_bin(bin);
+    if (points_angle[bin] == NO_ANG_DATA) return;
+
+    coord_reproject(bin, &points[bin][0], &points[bin][1]);
+    render_owner_change(old_x, old_y, bin, SHADE_LIVE, SHADE_NONE);
+    shade = history_claim(bin, points[bin][0], points[bin][1]);
+    render_owner_change(points[bin][0], points[bin][1], bin, shade, SHADE_LIVE);
+    contour_point_moved(bin, old_x, old_y);
+}
+
 // jd: TSK for drawing pixels to screen
 //      Activates after SPI SWI activates
 Void draw_point_Fxn(Void)
 {
+    Uint16 shade;
+    int16 moved;
     while(TRUE)
     {
         Semaphore_pend(draw_Sem, BIOS_WAIT_FOREVER);
+        PERF_COUNT(draws);
 
-        GpioDataRegs.GPACLEAR.bit.GPIO7 = 1; // // set LOW to allow for CPU utilization measurement via oscilloscope
+        HAL_CPU_BUSY(); // // set LOW to allow for CPU utilization measurement via oscilloscope
 
-        Semaphore_pend(lock_Sem, BIOS_WAIT_FOREVER); // lock out other TSK's
-        drawPixel(points[array_index][0], points[array_index][1], TARGET_COLOR);// draw pixel to screen
+        lock_Fxn(); // lock out other TSK's
+        if (shown_mode == DISPLAY_POLAR) // B-scan columns are drawn when the sweep leaves them
+        {
+            moved = (last_point[0] != points[draw_index][0]) || (last_point[1] != points[draw_index][1]);
+            if (coord_rescaled(draw_index))
+            {
+                // zoom changed since this angle was drawn: its old point and ghosts are at the wrong scale
+                history_drop_bin(draw_index);
+                if (last_point_valid)
+                {
+                    render_owner_change(last_point[0], last_point[1], draw_index, SHADE_LIVE, SHADE_NONE);
+                }
+            }
+            else if (last_point_valid && !moved)
+            {
+                // return did not move since the last sweep: only its faded phosphor color goes back to the brightest
+                render_point(draw_index);
+                contour_recolor(draw_index);
+                latency_shown(TRUE); // RAMWR of the repainted marker is done
+                Semaphore_post(lock_Sem); // release lock
+                continue;
+            }
+            // return from the last sweep moved: leave it behind as a fading ghost
+            else if (last_point_valid)
+            {
+                history_retire(draw_index, last_point[0], last_point[1]);
+            }
+            shade = history_claim(draw_index, points[draw_index][0], points[draw_index][1]);
+            render_owner_change(points[draw_index][0], points[draw_index][1], draw_index, shade, SHADE_LIVE);// draw pixel to screen
+            latency_shown(TRUE); // RAMWR of the new pixel is done
+            contour_point_moved(draw_index, last_point[0], last_point[1]); // rejoin with the neighbouring angles
+        }
+        latency_shown(FALSE); // no-op if it was recorded above (B-scan and waterfall draw later)
         Semaphore_post(lock_Sem); // release lock
     }
 }
@@ -223,35 +423,132 @@ Void draw_point_Fxn(Void)
 //      Activates after screen made full revolution after drawing a point
 Void redraw_point_Fxn(Void)
 {
+    Uint16 shade;
     while(TRUE)
     {
         Semaphore_pend(redraw_Sem, BIOS_WAIT_FOREVER);
+        PERF_COUNT(redraws);
 
-        GpioDataRegs.GPACLEAR.bit.GPIO7 = 1; // // set LOW to allow for CPU utilization measurement via oscilloscope
+        HAL_CPU_BUSY(); // // set LOW to allow for CPU utilization measurement via oscilloscope
 
-        Semaphore_pend(lock_Sem, BIOS_WAIT_FOREVER); // lock out other TSK's
-        drawPixel(last_point[0], last_point[1], BACKGROUND_COLOR); // clear pixel from screen
-        drawPixel(x_coord, y_coord, TARGET_COLOR);// draw current pixel to screen
+        lock_Fxn(); // lock out other TSK's
+        if (shown_mode == DISPLAY_POLAR)
+        {
+            render_owner_change(last_point[0], last_point[1], draw_index, SHADE_LIVE, SHADE_NONE); // clear pixel from screen (unless another angle still owns it)
+            shade = history_claim(draw_index, x_coord, y_coord);
+            render_owner_change(x_coord, y_coord, draw_index, shade, SHADE_LIVE);// draw current pixel to screen
+            latency_shown(TRUE); // RAMWR of the new pixel is done
+            contour_point_moved(draw_index, last_point[0], last_point[1]);
+        }
+        latency_shown(FALSE); // no-op if it was recorded above (B-scan and waterfall draw later)
         Semaphore_post(lock_Sem); // release lock
     }
 }
 
-// jd: TSK for clearing pixels from screen
-//      Activates after screen made full revolution after drawing a point
+// work done so far in SPI bytes: the bytes sent plus the bins the owner scans looked at
+// (OWNER_SCANS_PER_BYTE of them take about as long as sending a byte)
+static Uint32 tick_work_Fxn(void)
+{
+    return spi_byte_count + owner_scan_count / OWNER_SCANS_PER_BYTE;
+}
+
+// bytes left of this tick's budget when "start" was tick_work_Fxn() at the end of the last tick
+static Uint16 budget_left_Fxn(Uint32 start)
+{
+    Uint32 sent = tick_work_Fxn() - start;
+    return (sent < tick_budget) ? (Uint16)(tick_budget - sent) : 0;
+}
+
+// jd: TSK for aging pixels on screen
+//      Activates each time the sweep leaves an angle. A point from an earlier sweep that
+//      was not refreshed starts fading out, and older ghosts at that angle step one shade dimmer
 Void clear_point_Fxn(Void)
 {
+    int16 index, bin;
+    int16 tick_turn = 0;
+    Uint32 tick_start = tick_work_Fxn(); // the draw and redraw TSK's work since the last tick counts against it
     while(TRUE)
     {
         Semaphore_pend(clear_Sem, BIOS_WAIT_FOREVER);
 
-        GpioDataRegs.GPACLEAR.bit.GPIO7 = 1; // // set LOW to allow for CPU utilization measurement via oscilloscope
+        HAL_CPU_BUSY(); // // set LOW to allow for CPU utilization measurement via oscilloscope
 
-        Semaphore_pend(lock_Sem, BIOS_WAIT_FOREVER); // lock out other TSK's
-        while(((array_index + 1) % NUM_POINTS) != clear_index)
+        lock_Fxn(); // lock out other TSK's
+        if (shown_mode != display_mode)
+        {
+            switch_mode_Fxn();
+        }
+        while(clear_index != array_index)
         {
-            drawPixel(points[clear_index][0], points[clear_index][1], BACKGROUND_COLOR);
+            PERF_COUNT(clears);
+            if (shown_mode == DISPLAY_POLAR)
+            {
+                history_age_bin(clear_index);
+                if (!(fresh_bins[clear_index >> 4] & FRESH_BIT(clear_index)) && (points_angle[clear_index] != NO_ANG_DATA))
+                {
+                    points_angle[clear_index] = NO_ANG_DATA;
+                    history_retire(clear_index, points[clear_index][0], points[clear_index][1]);
+                    contour_point_moved(clear_index, points[clear_index][0], points[clear_index][1]); // open the contour here
+                }
+                fresh_bins[clear_index >> 4] &= ~FRESH_BIT(clear_index);
+                phosphor_advance(clear_index); // older returns step one color dimmer (sent by phosphor_tick())
+                coord_bin_left(clear_index); // auto-ranging picks the zoom at the end of the sweep
+            }
+            else
+            {
+                if (!(fresh_bins[clear_index >> 4] & FRESH_BIT(clear_index)))
+                {
+                    points_angle[clear_index] = NO_ANG_DATA; // not refreshed this sweep
+                }
+                fresh_bins[clear_index >> 4] &= ~FRESH_BIT(clear_index);
+                coord_bin_left(clear_index); // the B-scan and waterfall ranges follow the zoom too
+                if (shown_mode == DISPLAY_BSCAN)
+                {
+                    bscan_bin_left(clear_index); // stream the column once all its bins are done
+                }
+                else
+                {
+                    waterfall_bin_left(clear_index); // one new row per completed sweep
+                }
+            }
             clear_index = (clear_index + 1) % NUM_POINTS;
         }
+        if (shown_mode != DISPLAY_POLAR)
+        {
+            tick_start = tick_work_Fxn();
+            Semaphore_post(lock_Sem); // release lock (no sweep line or HUD on the B-scan or waterfall)
+            continue;
+        }
+        // whatever the points and the aging left of the tick budget goes to the zoom reprojection
+        // and the contour_mode pass first, then to the HUD, the phosphor recolors and the sweep line. Which of those three
+        // is served first rotates every tick, so none of them starves when the budget is tight.
+        for (index = 0; (index < ZOOM_BINS_PER_TICK) && (budget_left_Fxn(tick_start) != 0); index++)
+        {
+            bin = coord_next_stale(); // after a zoom change, reproject a few bins per tick
+            if (bin < 0) break;
+            rescale_bin_Fxn(bin);
+        }
+        for (index = 0; (index < CONTOUR_BINS_PER_TICK) && (budget_left_Fxn(tick_start) != 0); index++)
+        {
+            bin = contour_next_stale(); // after a contour_mode change, join or unjoin a few bins per tick
+            if (bin < 0) break;
+            contour_point_moved(bin, points[bin][0], points[bin][1]);
+        }
+        hud_set(HUD_RANGE, distance);
+        hud_set(HUD_BEARING, (angle - angle % (HUD_BEARING_BINS*ENCODER_ANG))/SF);
+        hud_set(HUD_RPM, (sweep_period != 0) ? (int16)((60*timestamp_freq)/sweep_period) : 0);
+        hud_set(HUD_CPU, (int16)CPU_data);
+        for (index = 0; index < 3; index++)
+        {
+            switch ((tick_turn + index) % 3)
+            {
+            case 0: hud_tick(budget_left_Fxn(tick_start)); break;
+            case 1: phosphor_tick(budget_left_Fxn(tick_start)); break;
+            default: sweep_line_tick(array_index, budget_left_Fxn(tick_start)); break;
+            }
+        }
+        tick_turn = (tick_turn + 1) % 3;
+        tick_start = tick_work_Fxn();
         Semaphore_post(lock_Sem); // release lock
     }
 }
@@ -0,0 +1,56 @@
+// main_file.h
+// Author: Joseph Dobrzanski
+// Shared state of the point store in main_file.c, so the rendering helpers
+// (sweep_history.c, ...) can work on the same per-bin data as the threads.
+
+#ifndef MAIN_FILE_H
+#define MAIN_FILE_H
+
+#include "Peripheral_Headers/F2802x_Device.h"
+
+// values for encoder (angle) things
+#define ENCODER_ANG 16       // number of degrees expected from each pulse of the encoder: 224.4count/rev -> 360deg/rev * SF
+#define SF  10               // scale factor (to get around floating point numbers)
+#define MAX_ANG  360         // maximum angle in circle (360 degrees)
+#define NUM_BINS ((MAX_ANG*SF)/ENCODER_ANG) // angles in one sweep (225)
+#define MOTOR_MAX_RPM 60     // fastest motor speed the display has to keep up with
+
+// SPI bytes clear_point_Fxn() may send per encoder tick at MOTOR_MAX_RPM, shared by the
+// points and everything it does besides aging the bins (phosphor, zoom reprojection,
+// sweep line, HUD). The SPI link runs at 500 kHz (~62 bytes/ms) and one tick lasts
+// 60000 / (MOTOR_MAX_RPM * NUM_BINS) ms, 4.4 ms (~270 bytes) at 60 RPM: the budget leaves
+// the rest to the idle thread, which has to empty the SCI FIFO before it overflows.
+// Slower sweeps have longer ticks and get a proportionally larger budget, up to TICK_BUDGET_MAX.
+#define TICK_BUDGET 112
+#define TICK_BUDGET_MAX 1024
+
+// Diagnostics with large buffers: the input trace ring (trace.c), the event trace ring and
+// hooks (evtrace.c) and the latency histogram (latency.c) take about 1K words of the 6K
+// words of RAM, so they are only built in with --define=DIAG_BUILD=1 (and the matching
+// --cfgArgs, main_file.cfg). The host build always has them. The perf.c counters and the
+// latency count and maximum are in every build.
+#ifndef DIAG_BUILD
+#define DIAG_BUILD 0
+#endif
+
+#define BACKGROUND_COLOR 0xFFFF
+#define TARGET_COLOR 0x0000
+
+// values for detected points on screen
+#define NUM_POINTS 230
+#define NO_ANG_DATA -1
+
+// views of the point store (display_mode)
+#define DISPLAY_POLAR   0   // sonar disc
+#define DISPLAY_BSCAN   1   // range vs bearing (bscan.c)
+#define DISPLAY_WATERFALL 2 // one row of nearest ranges per sweep, hardware scrolled (waterfall.c)
+
+extern int16 points[NUM_POINTS][2];
+extern int16 points_angle[NUM_POINTS];
+extern Uint16 sweep_count;
+extern int16 sweep_bins;
+extern Uint16 fresh_bins[(NUM_POINTS + 15) / 16]; // bins that got a new point during this sweep
+#define FRESH_BIT(index)    (1U << ((index) & 0xF))
+extern int16 display_mode;
+
+#endif
@@ -0,0 +1,117 @@
+// perf.c
+// Author: Joseph Dobrzanski
+// Counter updates that need more than an increment, and the SCI TX report,
+// sent from the idle thread a line at a time as the TX FIFO has room (not
+// while one of the traces or the latency line is being sent).
+
+#include "perf.h"
+#include "trace.h"
+#include "evtrace.h"
+#include "latency.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+struct perf_counters perf;
+int16 perf_report = 0;
+int16 perf_clear = 0;
+
+static int16 sweep_dropped = 0; // a bin of the current sweep was dropped
+static Uint32 spi_base = 0;     // spi_byte_count at the last perf_clear
+static char text[PERF_TEXT];
+static Uint16 text_pos = 0;     // next character of text[] sent
+static Uint16 line = 0;         // next counter in the report
+
+static const struct {
+    const char *name;
+    Uint32 *value;
+} fields[] = {
+    { "samples", &perf.samples },
+    { "sci_overruns", &perf.sci_overruns },
+    { "swi_posts", &perf.swi_posts },
+    { "conversions", &perf.conversions },
+    { "draws", &perf.draws },
+    { "redraws", &perf.redraws },
+    { "clears", &perf.clears },
+    { "spi_bytes", &perf.spi_bytes },
+    { "spi_commands", &perf.spi_commands },
+    { "lock_waits", &perf.lock_waits },
+    { "lock_wait", &perf.lock_wait },
+    { "lock_wait_max", &perf.lock_wait_max },
+    { "dropped_bins", &perf.dropped_bins },
+    { "dropped_sweeps", &perf.dropped_sweeps },
+};
+#define FIELDS  (sizeof(fields) / sizeof(fields[0]))
+
+// a task found lock_Sem held and got it "counts" Timestamp counts later
+void perf_lock_waited(Uint32 counts)
+{
+    perf.lock_waits++;
+    perf.lock_wait += counts;
+    if (counts > perf.lock_wait_max) perf.lock_wait_max = counts;
+}
+
+// encoder_Fxn is leaving a bin; "dropped" if no sample was converted for it
+void perf_bin_passed(int16 dropped)
+{
+    if (dropped) {
+        perf.dropped_bins++;
+        sweep_dropped = 1;
+    }
+}
+
+// a new sweep starts
+void perf_sweep_end(void)
+{
+    if (sweep_dropped) perf.dropped_sweeps++;
+    sweep_dropped = 0;
+}
+
+// "name value\r\n" of counter "index" into text[]
+static void format_line(Uint16 index)
+{
+    const char *name = fields[index].name;
+    Uint32 value = *fields[index].value;
+    char digits[11];
+    Uint16 length = 0;
+    int16 count = 0;
+
+    while (*name && (length < PERF_TEXT - 14)) text[length++] = *name++;
+    text[length++] = ' ';
+    do {
+        digits[count++] = '0' + (char)(value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0) text[length++] = digits[--count];
+    text[length++] = '\r';
+    text[length++] = '\n';
+    text[length] = 0;
+}
+
+// call from the idle thread: sends the next report characters while "perf_report" is set
+void perf_tick(void)
+{
+    Uint16 index;
+
+    if (perf_clear) {
+        for (index = 0; index < FIELDS; index++) *fields[index].value = 0;
+        sweep_dropped = 0;
+        spi_base = spi_byte_count;
+        perf_clear = 0;
+    }
+    perf.spi_bytes = spi_byte_count - spi_base;
+    if (!perf_report || trace_dump || evtrace_dump || latency_report) return;
+    for (;;) {
+        if (text_pos == 0) format_line(line);
+        while (text[text_pos] && HAL_SCI_TX_READY()) {
+            HAL_SCI_TX_BYTE(text[text_pos]);
+            text_pos++;
+        }
+        if (text[text_pos]) return; // FIFO full, carry on next time
+        text_pos = 0;
+        if (++line == FIELDS) {
+            line = 0;
+            perf_report = 0;
+            return;
+        }
+    }
+}
@@ -0,0 +1,44 @@
+// perf.h
+// Author: Joseph Dobrzanski
+// Run-time counters of the data path, to see why the CPU load is high and not
+// only how high it is (CPU_data). They are plain increments from the threads
+// that own each event, so a read from the debugger can catch one of them
+// mid-update; the numbers are for trends, not accounting. Read "perf" in the
+// "Expressions" watch list, or set "perf_report" to get one "name value" line
+// per counter over SCI TX. They are in every build (about 64 words of RAM).
+
+#ifndef PERF_H
+#define PERF_H
+
+#include "main_file.h"
+
+struct perf_counters {
+    Uint32 samples;         // distances read from the SCI receive FIFO (idle)
+    Uint32 sci_overruns;    // receive FIFO overflows seen by the idle thread (bytes were lost)
+    Uint32 swi_posts;       // Swi_post(mySwi) for a new sample
+    Uint32 conversions;     // polar_to_cart_Fxn runs (fewer than swi_posts when posts merge)
+    Uint32 draws;           // draw_point jobs
+    Uint32 redraws;         // redraw_point jobs
+    Uint32 clears;          // bins aged by clear_point
+    Uint32 spi_bytes;       // bytes sent to the screen (spi_byte_count, copied in the idle thread)
+    Uint32 spi_commands;    // of which commands (CASET, RASET, RAMWR, ...)
+    Uint32 lock_waits;      // pends on lock_Sem that found it held by another task
+    Uint32 lock_wait;       // Timestamp counts spent waiting for lock_Sem
+    Uint32 lock_wait_max;   // longest single wait
+    Uint32 dropped_bins;    // bins the encoder left without a sample converted for them
+    Uint32 dropped_sweeps;  // sweeps with at least one dropped bin
+};
+
+#define PERF_COUNT(field)   (perf.field++)
+#define PERF_TEXT           32      // longest report line
+
+extern struct perf_counters perf;
+extern int16 perf_report;   // set to 1 through the "Expressions" watch list to send the counters, back to 0 when sent
+extern int16 perf_clear;    // set to 1 through the "Expressions" watch list to zero the counters
+
+void perf_lock_waited(Uint32 counts);
+void perf_bin_passed(int16 dropped);
+void perf_sweep_end(void);
+void perf_tick(void);
+
+#endif
@@ -0,0 +1,97 @@
+// phosphor.c
+// Author: Joseph Dobrzanski
+// Phosphor decay of live returns. The age of a return is the number of bins the
+// sweep has moved on since it left the return's bin, so when the sweep leaves
+// one more bin only the bins that are exactly a multiple of PHOSPHOR_BINS behind
+// it change color. That is at most PHOSPHOR_STEPS - 1 markers (and their contour
+// segments) per bin, whatever the number of returns on screen.
+// phosphor_advance() only records the bins clear_point_Fxn() passes; the recolors
+// are sent by phosphor_tick() out of the tick's shared SPI budget. The step each
+// return is drawn in is kept per bin, so when the budget runs out and recolors
+// are dropped the shades still match the screen (the return stays brighter).
+// Ages wrap on the length of the last sweep (sweep_bins), not on NUM_POINTS: the
+// slots past it are not swept and stay empty.
+// Call phosphor_tick() with lock_Sem held.
+
+#include "phosphor.h"
+#include "sweep_history.h"
+#include "render.h"
+#include "contour.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+// two bits per bin: phosphor step the return of the bin is drawn in
+#define PAINTED_SHIFT(bin)  (((bin) & 7) << 1)
+
+Uint16 phosphor_max_bytes = 0;
+
+static Uint16 painted[(NUM_POINTS + 7) / 8];
+static int16 swept_index = NUM_POINTS - 1; // last bin whose recolors have been sent (or dropped)
+static int16 left_index = NUM_POINTS - 1;  // last bin the sweep has left
+
+static void set_painted(int16 bin, Uint16 step)
+{
+    painted[bin >> 3] = (painted[bin >> 3] & ~(3U << PAINTED_SHIFT(bin))) | (step << PAINTED_SHIFT(bin));
+}
+
+// palette index of the live return of "bin": SHADE_LIVE while the sweep is still on it,
+// then one step dimmer every PHOSPHOR_BINS bins
+Uint16 phosphor_shade(int16 bin)
+{
+    if (fresh_bins[bin >> 4] & FRESH_BIT(bin)) return SHADE_LIVE;
+    return phosphor_aged(bin);
+}
+
+// palette index the decay gave the return of "bin" (whether or not the sweep has refreshed it
+// since): a return that is swept again without moving has to be repainted when this is not SHADE_LIVE
+Uint16 phosphor_aged(int16 bin)
+{
+    return SHADE_LIVE + ((painted[bin >> 3] >> PAINTED_SHIFT(bin)) & 3);
+}
+
+// the sweep has left "bin": its return was drawn live while the sweep was on it
+void phosphor_advance(int16 bin)
+{
+    set_painted(bin, 0);
+    left_index = bin;
+}
+
+// send the recolors of the bins the sweep has left while fewer than "budget" bytes have gone out.
+// Once the budget is spent, bins more than PHOSPHOR_BINS behind the sweep are passed without
+// their recolors, so a busy tick never waits for the decay.
+void phosphor_tick(Uint16 budget)
+{
+    Uint32 start = spi_byte_count;
+    Uint16 sent;
+    int16 step, index, bin;
+
+    while (swept_index != left_index) {
+        bin = (swept_index + 1) % NUM_POINTS;
+        HAL_COST(COST_DIV16, 1);
+        HAL_COST(COST_CYCLES, 12);
+        if (bin >= sweep_bins) {
+            swept_index = bin; // not swept: nothing ages here
+            continue;
+        }
+        for (step = 1; step < PHOSPHOR_STEPS; step++) {
+            HAL_COST(COST_CYCLES, 14);
+            index = bin - step*PHOSPHOR_BINS;
+            while (index < 0) index += sweep_bins;
+            if ((points_angle[index] != NO_ANG_DATA) && (phosphor_aged(index) != SHADE_LIVE + step)) {
+                if ((spi_byte_count - start) >= budget) break;
+                set_painted(index, step);
+                render_point(index);
+                contour_recolor(index);
+            }
+        }
+        if ((step < PHOSPHOR_STEPS) && ((left_index - swept_index + NUM_POINTS) % NUM_POINTS <= PHOSPHOR_BINS)) {
+            break; // budget spent: the rest of this bin goes out on a later tick
+        }
+        swept_index = bin; // done, or too far behind: the recolors left are dropped
+    }
+
+    sent = spi_byte_count - start;
+    if (sent > phosphor_max_bytes) {
+        phosphor_max_bytes = sent;
+    }
+}
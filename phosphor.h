@@ -0,0 +1,22 @@
+// phosphor.h
+// Author: Joseph Dobrzanski
+// Phosphor decay of live returns: a return is drawn in the brightest color when
+// the sweep passes it and steps one palette color dimmer every PHOSPHOR_BINS
+// encoder ticks after that, until the sweep comes round again.
+
+#ifndef PHOSPHOR_H
+#define PHOSPHOR_H
+
+#include "main_file.h"
+
+#define PHOSPHOR_STEPS  3   // live palette colors a return steps through (1 = no decay, max 3)
+#define PHOSPHOR_BINS   45  // encoder ticks per step (45 bins = 72 degrees)
+
+extern Uint16 phosphor_max_bytes; // worst-case bytes measured for one tick (see "Expressions")
+
+Uint16 phosphor_shade(int16 bin);
+Uint16 phosphor_aged(int16 bin);
+void phosphor_advance(int16 bin);
+void phosphor_tick(Uint16 budget);
+
+#endif
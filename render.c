@@ -0,0 +1,263 @@
+// render.c
+// Author: Joseph Dobrzanski
+// Per-pixel ownership for points drawn by the threads in main_file.c.
+// Storing a reference count for each of the 130x130 pixels does not fit in the
+// F28027's RAM, so the owners of a pixel are counted on demand from the point
+// store and the ghost chains of the bins that can land on that pixel.
+// The screen always shows the best owner: a live point's marker or contour, else the
+// youngest ghost, else the background layer (rim, rings, spokes, ...).
+// Call with lock_Sem held.
+
+#include "render.h"
+#include "layers.h"
+#include "contour.h"
+#include "phosphor.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+// footprint of each marker on a 5x5 grid around its point: bit (dy + 2)*5 + (dx + 2)
+const Uint32 marker_masks[NUM_MARKERS] = {
+    0x00001000, // MARKER_DOT
+    0x00063000, // MARKER_BOX2
+    0x000739C0, // MARKER_BOX3
+    0x00023880, // MARKER_CROSS
+    0x00455544, // MARKER_DIAMOND
+};
+
+// close targets get the most visible marker (radius from the disc center)
+const struct marker_band marker_bands[NUM_MARKER_BANDS] = {
+    {24, MARKER_DIAMOND},
+    {48, MARKER_BOX3},
+    {0x7FFF, MARKER_CROSS},
+};
+
+static int16 abs16(int16 v)
+{
+    return (v < 0) ? -v : v;
+}
+
+// marker shape of a live point at (x, y)
+Uint16 marker_for(int16 x, int16 y)
+{
+#if MARKER_MODE == MARKER_BY_RANGE
+    int16 dx = abs16(x - DISC_X);
+    int16 dy = abs16(y - DISC_Y);
+    int16 r = (dx > dy) ? dx : dy;
+    int band;
+
+    HAL_COST(COST_CYCLES, 15);
+    for (band = 0; band < NUM_MARKER_BANDS - 1; band++) {
+        HAL_COST(COST_CYCLES, 8);
+        if (r <= marker_bands[band].max_r) break;
+    }
+    return marker_bands[band].shape;
+#else
+    return MARKER_MODE;
+#endif
+}
+
+// true if the live point of this bin has (x, y) inside its marker, or its contour segment runs through it
+static int live_covers(int16 bin, int16 x, int16 y)
+{
+    int16 dx, dy;
+
+    HAL_COST(COST_CYCLES, 8);
+    if (points_angle[bin] == NO_ANG_DATA) return 0;
+    dx = x - points[bin][0];
+    dy = y - points[bin][1];
+    HAL_COST(COST_CYCLES, 14);
+    if ((abs16(dx) > 2) || (abs16(dy) > 2)) {
+        // the segment to the next bin stays inside the box of its two ends, less than
+        // CONTOUR_MAX_PX apart: most bins the owner scan asks about are further away
+        if ((abs16(dx) >= CONTOUR_MAX_PX) || (abs16(dy) >= CONTOUR_MAX_PX)) return 0;
+        return contour_covers(bin, x, y);
+    }
+    if (contour_covers(bin, x, y)) return 1;
+    HAL_COST(COST_CYCLES, 12);   // shift of the 32-bit mask by a variable count
+    return (marker_masks[marker_for(points[bin][0], points[bin][1])] >> ((dy + 2)*5 + (dx + 2))) & 1;
+}
+
+int16 render_hysteresis = 0;
+Uint32 owner_scan_count = 0;
+
+// bins on either side of a pixel at Chebyshev radius r that can own it
+static int16 owner_span(int16 r)
+{
+    int16 span;
+
+    // Chebyshev distance is never larger than the true radius, so the span errs on the wide side
+    HAL_COST(COST_DIV16, 1);
+    HAL_COST(COST_CYCLES, 25);
+    span = (r > 0) ? 1 + (OWNER_SPAN(render_hysteresis) + MARKER_SPAN)/r : NUM_POINTS/2;
+    return (span > NUM_POINTS/2) ? NUM_POINTS/2 : span;
+}
+
+// shade "index" owns (x, y) with, SHADE_NONE if none
+static Uint16 owner_shade(int16 index, int16 x, int16 y)
+{
+    owner_scan_count++;
+    HAL_COST(COST_OWNER, 1);
+    return live_covers(index, x, y) ? phosphor_shade(index) : history_shade_at(index, x, y);
+}
+
+// best shade among the owners of (x, y) in bins other than "bin" (SHADE_NONE if unowned)
+Uint16 pixel_shade_others(int16 x, int16 y, int16 bin)
+{
+    int16 dx = abs16(x - DISC_X);
+    int16 dy = abs16(y - DISC_Y);
+    int16 span, offset, index;
+    Uint16 best = SHADE_NONE;
+    Uint16 shade;
+
+    span = owner_span((dx > dy) ? dx : dy);
+
+    // one modulo for the whole scan, the index then wraps by compare
+    index = (bin - span - 1 + NUM_POINTS) % NUM_POINTS;
+    HAL_COST(COST_DIV16, 1);
+    for (offset = -span; offset <= span; offset++) {
+        if (++index == NUM_POINTS) index = 0;
+        if (offset == 0) continue;
+        shade = owner_shade(index, x, y);
+        if (shade == SHADE_LIVE) return shade; // nothing is brighter than a freshly swept point
+        if (shade < best) best = shade;
+    }
+    return best;
+}
+
+// best shade among all owners of (x, y), "bin" being a bin that can land on that pixel
+Uint16 pixel_shade(int16 x, int16 y, int16 bin)
+{
+    Uint16 best, own;
+
+    HAL_COST(COST_CYCLES, 10);
+    own = live_covers(bin, x, y) ? phosphor_shade(bin) : history_shade_at(bin, x, y);
+    if (own == SHADE_LIVE) return own;
+    best = pixel_shade_others(x, y, bin);
+    return (own < best) ? own : best;
+}
+
+static int16 marker_owners[NUM_POINTS - 1];   // bins that can own a pixel of the marker being drawn
+
+// the bins other than "bin" that can own a pixel within 2 of (x, y), into marker_owners[].
+// The span of the box's innermost pixel covers all of its pixels, and of those bins only the
+// ones with a live point less than CONTOUR_MAX_PX from the box (its marker and contour segment
+// stay that close) or a ghost inside it are kept, so the pixels of a marker share one scan.
+static int16 marker_owners_at(int16 x, int16 y, int16 bin)
+{
+    int16 dx = abs16(x - DISC_X);
+    int16 dy = abs16(y - DISC_Y);
+    int16 r = ((dx > dy) ? dx : dy) - 2;
+    int16 span, offset, index;
+    int16 count = 0;
+
+    span = owner_span((r > 0) ? r : 0);
+    index = (bin - span - 1 + NUM_POINTS) % NUM_POINTS;
+    HAL_COST(COST_DIV16, 1);
+    for (offset = -span; offset <= span; offset++) {
+        if (++index == NUM_POINTS) index = 0;
+        if (offset == 0) continue;
+        owner_scan_count++;
+        HAL_COST(COST_OWNER, 1);
+        if ((points_angle[index] != NO_ANG_DATA)
+            && (abs16(points[index][0] - x) < CONTOUR_MAX_PX + 2) && (abs16(points[index][1] - y) < CONTOUR_MAX_PX + 2)) {
+            marker_owners[count++] = index;
+        } else if (history_near(index, x, y, 2)) {
+            marker_owners[count++] = index;
+        }
+    }
+    return count;
+}
+
+// pixel_shade() of a pixel of the marker, with the other owners taken from marker_owners[]
+static Uint16 marker_pixel_shade(int16 x, int16 y, int16 bin, int16 count)
+{
+    Uint16 best, shade;
+    int16 i;
+
+    HAL_COST(COST_CYCLES, 10);
+    best = live_covers(bin, x, y) ? phosphor_shade(bin) : history_shade_at(bin, x, y);
+    for (i = 0; (i < count) && (best != SHADE_LIVE); i++) {
+        shade = owner_shade(marker_owners[i], x, y);
+        if (shade < best) best = shade;
+    }
+    return best;
+}
+
+// repaint the window of the marker at (x, y) in one RAMWR run, every pixel in the color
+// of its best owner (or background layer)
+static void render_marker(int16 x, int16 y, int16 bin, Uint32 mask)
+{
+    int16 x0 = x + 2, y0 = y + 2, x1 = x - 2, y1 = y - 2;
+    int16 dx, dy, count;
+    Uint16 shade;
+
+    // bounding box of the footprint, clipped to the screen
+    for (dy = -2; dy <= 2; dy++) {
+        for (dx = -2; dx <= 2; dx++) {
+            HAL_COST(COST_CYCLES, 12);
+            if ((mask >> ((dy + 2)*5 + (dx + 2))) & 1) {
+                HAL_COST(COST_CYCLES, 16);
+                if (x + dx < x0) x0 = x + dx;
+                if (x + dx > x1) x1 = x + dx;
+                if (y + dy < y0) y0 = y + dy;
+                if (y + dy > y1) y1 = y + dy;
+            }
+        }
+    }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= _width) x1 = _width - 1;
+    if (y1 >= _height) y1 = _height - 1;
+    if ((x0 > x1) || (y0 > y1)) return;
+
+    count = marker_owners_at(x, y, bin);
+    _startWrite(x0, y0, x1, y1);
+    for (dy = y0; dy <= y1; dy++) {
+        for (dx = x0; dx <= x1; dx++) {
+            HAL_COST(COST_CYCLES, 10);
+            shade = marker_pixel_shade(dx, dy, bin, count);
+            _pushColor((shade == SHADE_NONE) ? layer_color(dx, dy) : history_palette[shade]);
+        }
+    }
+}
+
+// the owner of (x, y) in "bin" changed from old_shade to new_shade (either may be SHADE_NONE).
+// The point store and ghost chains must already hold the new state.
+void render_owner_change(int16 x, int16 y, int16 bin, Uint16 old_shade, Uint16 new_shade)
+{
+    Uint16 others, before, after;
+    Uint32 mask;
+
+    if (old_shade == new_shade) return;
+    HAL_COST(COST_CYCLES, 20);
+    if ((old_shade == SHADE_LIVE) || (new_shade == SHADE_LIVE)) {
+        mask = marker_masks[marker_for(x, y)];
+        if (mask != marker_masks[MARKER_DOT]) {
+            // a live marker appeared or left: draw/erase its whole footprint in one window
+            render_marker(x, y, bin, mask);
+            return;
+        }
+    }
+
+    // SHADE_LIVE stands for this bin's live return, in its current phosphor color
+    if (old_shade == SHADE_LIVE) old_shade = phosphor_shade(bin);
+    if (new_shade == SHADE_LIVE) new_shade = phosphor_shade(bin);
+    others = pixel_shade_others(x, y, bin);
+    if ((old_shade >= SHADE_GHOST) && (new_shade >= SHADE_GHOST) && live_covers(bin, x, y) && (phosphor_shade(bin) < others)) {
+        others = phosphor_shade(bin); // a ghost under the marker of its own bin's new return
+    }
+    before = (old_shade < others) ? old_shade : others;
+    after = (new_shade < others) ? new_shade : others;
+    if (before != after) {
+        drawPixel(x, y, (after == SHADE_NONE) ? layer_color(x, y) : history_palette[after]);
+    }
+}
+
+// repaint the marker of the live return of "bin" (its phosphor color changed)
+void render_point(int16 bin)
+{
+    int16 x = points[bin][0];
+    int16 y = points[bin][1];
+
+    render_marker(x, y, bin, marker_masks[marker_for(x, y)]);
+}
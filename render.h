@@ -0,0 +1,55 @@
+// render.h
+// Author: Joseph Dobrzanski
+// Per-pixel ownership for points drawn by the threads in main_file.c.
+// At short range neighbouring bins land on the same pixel, so a pixel is only
+// written when the best (brightest) remaining owner changes, and an unowned
+// pixel gets its background layer color back (layers.c).
+// Live points are drawn as multi-pixel target markers; ghosts stay single pixels.
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "main_file.h"
+#include "sweep_history.h"
+
+// owners of a pixel can only come from bins within 1 + (OWNER_SPAN(h) + MARKER_SPAN)/r of each other
+// (r = pixel radius, h = render_hysteresis): 2 * (0.71 px rounding + h px hysteresis) / 1.6 deg,
+// rounded up, plus 2 * 2.83 px / 1.6 deg for a marker reaching 2 pixels away from its point
+#define OWNER_SPAN(h)   (51 + 72*(h))
+#define MARKER_SPAN     203
+
+extern int16 render_hysteresis; // largest delta_hysteresis a point has been held with since boot
+
+// bins looked at by the owner scans since boot. One takes ~60 cycles (host/sim budget report),
+// so this many take about as long as an SPI byte and count as one against the tick budget.
+#define OWNER_SCANS_PER_BYTE 16
+extern Uint32 owner_scan_count;
+
+// target marker shapes (footprints in marker_masks[])
+#define MARKER_DOT      0   // 1 pixel
+#define MARKER_BOX2     1   // 2x2
+#define MARKER_BOX3     2   // 3x3
+#define MARKER_CROSS    3   // 3x3 plus sign
+#define MARKER_DIAMOND  4   // 5x5 diamond outline with center dot
+#define NUM_MARKERS     5
+
+// MARKER_MODE: MARKER_BY_RANGE picks the shape from marker_bands[], any MARKER_* uses that shape
+#define MARKER_BY_RANGE NUM_MARKERS
+#define MARKER_MODE     MARKER_BY_RANGE
+
+struct marker_band {
+    int16 max_r;    // band covers points up to this radius (pixels)
+    Uint16 shape;
+};
+
+#define NUM_MARKER_BANDS 3
+extern const Uint32 marker_masks[NUM_MARKERS];
+extern const struct marker_band marker_bands[NUM_MARKER_BANDS];
+
+Uint16 marker_for(int16 x, int16 y);
+Uint16 pixel_shade_others(int16 x, int16 y, int16 bin);
+Uint16 pixel_shade(int16 x, int16 y, int16 bin);
+void render_owner_change(int16 x, int16 y, int16 bin, Uint16 old_shade, Uint16 new_shade);
+void render_point(int16 bin);
+
+#endif
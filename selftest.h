@@ -0,0 +1,22 @@
+// selftest.h
+// Author: Joseph Dobrzanski
+// Boot-time benchmark and self-test. With S1.1 (GPIO34) low after the screen
+// has started up, the hot kernels are timed with CPU timer 1, the coordinate
+// conversion is checked, and a report goes out over SCI TX (GPIO29) before the
+// module carries on with normal operation. GPIO34 is also a boot-mode pin:
+// flip the switch after reset, or start from the debugger.
+
+#ifndef SELFTEST_H
+#define SELFTEST_H
+
+#include "main_file.h"
+
+#define SELFTEST_CPU_MHZ    60      // SYSCLKOUT, for the microsecond column
+#define SELFTEST_CALLS      32      // calls timed per kernel
+#define SELFTEST_SPI_PIXELS 512     // pixels (two bytes each) streamed for the SPI throughput
+
+extern Uint16 selftest_failures;    // checks that failed in the last self-test
+
+void selftest_run(void);
+
+#endif
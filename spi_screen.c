@@ -11,27 +11,207 @@ https://github.com/matevzmars/ST7735R
 //       - Modified all commands to be useable in CSS
 //       - Rewrote drawCircle entirely to create "donut"
 //       - Added SPIA function to allow for communication to screen using SPIA interface
+//       - Fixed low colour byte mask (was & 0x0F, which broke any colour other than black/white)
+//       - Address window caching and an SPI byte counter
+//       - Implemented _writeCharacter as a single-window glyph blit with its own 5x7 font
+//       - Added hardware vertical scrolling (VSCRDEF/VSCSAD)
+//       - Drawing goes through the display driver interface (display.h); the MIPI DCS
+//         panels on SPIA (ST7735, ST7789, ILI9341) are the backends in this file
+//       - Pins and SPIA registers are reached through hal.h
 
 #include <spi_screen.h>
+#include "hal.h"
+#include "perf.h"
+
+Uint32 spi_byte_count = 0; // jd: bytes sent to the screen, for measuring SPI cost
+
+// jd: 5x7 font for ' ' to 'Z' (one byte per column, bit 0 = top row), kept in flash
+#define FONT_FIRST  ' '
+#define FONT_LAST   'Z'
+static const uint8_t font5x7[][FONT_W] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, // '!'
+    {0x00, 0x07, 0x00, 0x07, 0x00}, // '"'
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // '#'
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // '$'
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // '%'
+    {0x36, 0x49, 0x55, 0x22, 0x50}, // '&'
+    {0x00, 0x05, 0x03, 0x00, 0x00}, // '''
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, // '('
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, // ')'
+    {0x08, 0x2A, 0x1C, 0x2A, 0x08}, // '*'
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, // '+'
+    {0x00, 0x50, 0x30, 0x00, 0x00}, // ','
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // '-'
+    {0x00, 0x60, 0x60, 0x00, 0x00}, // '.'
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // '/'
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // '0'
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // '1'
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // '2'
+    {0x21, 0x41, 0x45, 0x4B, 0x31}, // '3'
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // '4'
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // '5'
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // '6'
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // '7'
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // '8'
+    {0x06, 0x49, 0x49, 0x29, 0x1E}, // '9'
+    {0x00, 0x36, 0x36, 0x00, 0x00}, // ':'
+    {0x00, 0x56, 0x36, 0x00, 0x00}, // ';'
+    {0x08, 0x14, 0x22, 0x41, 0x00}, // '<'
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // '='
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // '>'
+    {0x02, 0x01, 0x51, 0x09, 0x06}, // '?'
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, // '@'
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // 'A'
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // 'B'
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // 'C'
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // 'D'
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // 'E'
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, // 'F'
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, // 'G'
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // 'H'
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // 'I'
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, // 'J'
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, // 'K'
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, // 'L'
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // 'M'
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // 'N'
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // 'O'
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // 'P'
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // 'Q'
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // 'R'
+    {0x46, 0x49, 0x49, 0x49, 0x31}, // 'S'
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, // 'T'
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // 'U'
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // 'V'
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // 'W'
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // 'X'
+    {0x07, 0x08, 0x70, 0x08, 0x07}, // 'Y'
+    {0x61, 0x51, 0x49, 0x45, 0x43}, // 'Z'
+};
+
+// jd: last address window sent to the screen (-1 = unknown)
+static int win_x0 = -1;
+static int win_x1 = -1;
+static int win_y0 = -1;
+static int win_y1 = -1;
 
 
 // initialize screen
-// jd: has lots of debug code commented out, removed some unneeded commands
+// jd: powers up the panel of the selected display driver
 void screen_begin(void)
+{
+    display->begin();
+}
+
+// jd: ST7735 (130x130), has lots of debug code commented out, removed some unneeded commands
+static void st7735_begin(void)
 {
     //GpioDataRegs.GPASET.bit.GPIO1 = 1; // disable screen
 
+    win_x0 = win_x1 = win_y0 = win_y1 = -1;
     _writeCommand(SLPOUT); //don't sleep
     _writeCommand(DISPON);  // turn display on
     _writeCommand(COLMOD);  // request bit per pixel change
     _writeData(0x05);  // 16 bit per pixel
 }
 
+// jd: ST7789 (240x240)
+static void st7789_begin(void)
+{
+    win_x0 = win_x1 = win_y0 = win_y1 = -1;
+    _writeCommand(SLPOUT); // don't sleep
+    delay_loop(STD_DEL);   // sleep out takes up to 120 ms
+    _writeCommand(COLMOD);
+    _writeData(0x55);      // 16 bit per pixel
+    _writeCommand(MADCTL);
+    _writeData(FLIP_0);
+    _writeCommand(INVON);  // IPS panel colors are inverted otherwise
+    _writeCommand(DISPON);
+}
+
+// jd: ILI9341 (320x240, landscape)
+static void ili9341_begin(void)
+{
+    win_x0 = win_x1 = win_y0 = win_y1 = -1;
+    _writeCommand(SLPOUT); // don't sleep
+    delay_loop(STD_DEL);   // sleep out takes up to 120 ms
+    _writeCommand(COLMOD);
+    _writeData(0x55);      // 16 bit per pixel
+    _writeCommand(MADCTL);
+    _writeData(0x28);      // row/column exchange (landscape), BGR
+    _writeCommand(DISPON);
+}
+
+// jd: open an address window and start a RAMWR run on a DCS panel
+static void dcs_window(int16 x0, int16 y0, int16 x1, int16 y1)
+{
+    _setAddressWindow(x0, y0, x1, y1);
+    _writeCommand(RAMWR);
+
+    HAL_LCD_DATA();
+    HAL_LCD_SELECT();
+}
+
+// jd: one pixel of a RAMWR run
+static void dcs_push(Uint16 color)
+{
+    spi_send(color >> 8);
+    spi_send(color & 0xFF);
+}
+
+// jd: "count" pixels of one color in a RAMWR run
+static void dcs_fill(Uint16 color, Uint32 count)
+{
+    Uint16 hi = color >> 8;
+    Uint16 lo = color & 0xFF;
+
+    while (count-- > 0) {
+        spi_send(hi);
+        spi_send(lo);
+    }
+}
+
+// jd: define the vertical scroll area: "top" fixed rows, "rows" scrolling rows, "bottom" fixed rows
+//      (top + rows + bottom must be the driver's gram_rows)
+static void dcs_scroll_area(int16 top, int16 rows, int16 bottom)
+{
+    _writeCommand(VSCRDEF);
+    _writeData(top >> 8);
+    _writeData(top & 0xFF);
+    _writeData(rows >> 8);
+    _writeData(rows & 0xFF);
+    _writeData(bottom >> 8);
+    _writeData(bottom & 0xFF);
+}
+
+// jd: show display RAM row "line" at the top of the scroll area
+static void dcs_scroll(int16 line)
+{
+    _writeCommand(VSCSAD);
+    _writeData(line >> 8);
+    _writeData(line & 0xFF);
+}
+
+const struct display_driver display_st7735 = {
+    "ST7735", display_st7735_W, display_st7735_H, 162, st7735_begin, dcs_window, dcs_push, dcs_fill, dcs_scroll_area, dcs_scroll
+};
+
+const struct display_driver display_st7789 = {
+    "ST7789", display_st7789_W, display_st7789_H, 320, st7789_begin, dcs_window, dcs_push, dcs_fill, dcs_scroll_area, dcs_scroll
+};
+
+// in landscape the panel's scroll direction runs along the columns, so rows cannot be scrolled
+const struct display_driver display_ili9341 = {
+    "ILI9341", display_ili9341_W, display_ili9341_H, 0, ili9341_begin, dcs_window, dcs_push, dcs_fill, dcs_scroll_area, dcs_scroll
+};
+
 // send a command to the screen
 // jd: made CCS compatible
 void _writeCommand(int c){
-    GpioDataRegs.GPACLEAR.bit.GPIO2 = 1; // tell screen to accept a command
-    GpioDataRegs.GPACLEAR.bit.GPIO7 = 1;// (select screen)
+    HAL_LCD_COMMAND(); // tell screen to accept a command
+    PERF_COUNT(spi_commands);
+    HAL_LCD_SELECT();// (select screen)
     spi_send(c);delay_loop(75);
     //GpioDataRegs.GPASET.bit.GPIO7 = 1; // (de-select screen)
 }
@@ -39,25 +219,35 @@ void _writeCommand(int c){
 // send data to display on the screen
 // jd: made CCS compatible
 void _writeData(int c){
-    GpioDataRegs.GPASET.bit.GPIO2 = 1; // tell screen to accept data
-    GpioDataRegs.GPACLEAR.bit.GPIO7 = 1;// (select screen)
+    HAL_LCD_DATA(); // tell screen to accept data
+    HAL_LCD_SELECT();// (select screen)
     spi_send(c);delay_loop(75);
     //GpioDataRegs.GPASET.bit.GPIO7 = 1; // (de-select screen)
 }
 
 // jd: made CCS compatible
+//      only sends CASET/RASET when the columns/rows differ from the last window,
+//      16 bit coordinates for the larger panels
 void _setAddressWindow(int x0, int y0, int x1, int y1){
-    _writeCommand(CASET); //column addr set
-    _writeData(0x00);
-    _writeData(x0); //xstart
-    _writeData(0x00);
-    _writeData(x1); //xend
+    if((x0 != win_x0) || (x1 != win_x1)){
+        _writeCommand(CASET); //column addr set
+        _writeData(x0 >> 8);
+        _writeData(x0 & 0xFF); //xstart
+        _writeData(x1 >> 8);
+        _writeData(x1 & 0xFF); //xend
+        win_x0 = x0;
+        win_x1 = x1;
+    }
 
-    _writeCommand(RASET); //row addr set
-    _writeData(0x00);
-    _writeData(y0); //ystart
-    _writeData(0x00);
-    _writeData(y1); //yend
+    if((y0 != win_y0) || (y1 != win_y1)){
+        _writeCommand(RASET); //row addr set
+        _writeData(y0 >> 8);
+        _writeData(y0 & 0xFF); //ystart
+        _writeData(y1 >> 8);
+        _writeData(y1 & 0xFF); //yend
+        win_y0 = y0;
+        win_y1 = y1;
+    }
 }
 
 // jd: made CCS compatible
@@ -66,22 +256,8 @@ void fillRect(int x, int y, int w, int h, int color){
     if((x + w - 1) >= _width)  w = _width  - x;
     if((y + h - 1) >= _height) h = _height - y;
 
-   _setAddressWindow(x, y, x+w-1, y+h-1);
-
-    int hi = color >> 8;
-    int lo = color & 0x0F;
-
-    _writeCommand(RAMWR);
-
-    GpioDataRegs.GPASET.bit.GPIO2 = 1;
-    GpioDataRegs.GPACLEAR.bit.GPIO7 = 1;
-
-    for(y=h;y>0;y--){
-        for(x=w;x>0;x--){
-            spi_send(hi);
-            spi_send(lo);
-        }
-    }
+    _startWrite(x, y, x+w-1, y+h-1);
+    _fillColor(color, (Uint32)w*h);
 
     //GpioDataRegs.GPASET.bit.GPIO7 = 1;
 }
@@ -95,17 +271,36 @@ void fillScreen(int color){
 void drawPixel(int x, int y, int color){
     if((x < 0) ||(x >= _width) || (y < 0) || (y >= _height)) return;
 
-    _setAddressWindow(x,y,x+1,y+1);
-    _writeCommand(RAMWR);
+    _startWrite(x,y,x,y);
+    _pushColor(color);
+    //GpioDataRegs.GPASET.bit.GPIO7 = 1;
+}
 
-    int hi = color >> 8;
-    int lo = color & 0x0F;
+// jd: open an address window on the selected display, then send each pixel with _pushColor()
+//      or runs of one color with _fillColor() (pixels fill the window left to right, top to bottom)
+void _startWrite(int x0, int y0, int x1, int y1){
+    display->window(x0, y0, x1, y1);
+}
 
-    GpioDataRegs.GPASET.bit.GPIO2 = 1;
-    GpioDataRegs.GPACLEAR.bit.GPIO7 = 1;
-    spi_send(hi);
-    spi_send(lo);
-    //GpioDataRegs.GPASET.bit.GPIO7 = 1;
+// jd: send one pixel of a window opened with _startWrite()
+void _pushColor(int color){
+    display->push(color);
+}
+
+// jd: send "count" pixels of one color of a window opened with _startWrite()
+void _fillColor(int color, Uint32 count){
+    display->fill(color, count);
+}
+
+// jd: define the vertical scroll area: "top" fixed rows, "rows" scrolling rows, "bottom" fixed rows
+//      (top + rows + bottom must be display->gram_rows)
+void setScrollArea(int top, int rows, int bottom){
+    display->scroll_area(top, rows, bottom);
+}
+
+// jd: show display RAM row "line" at the top of the scroll area
+void scrollTo(int line){
+    display->scroll(line);
 }
 
 // jd: rewrote this function to make "donut"
@@ -114,22 +309,11 @@ void drawCircle(int x, int y, int r_in, int r_out, int color_bg, int color_rim){
   if((x + r_out - 1) >= _width)  r_out = _width  - x;
   if((y + r_out - 1) >= _height) r_out = _height - y;
 
-  _setAddressWindow(x-r_out, y-r_out, x+r_out, y+r_out);
+  _startWrite(x-r_out, y-r_out, x+r_out, y+r_out);
 
   int r_out_square = r_out*r_out;
   int r_in_square = r_in*r_in;
 
-  int hi_bg = color_bg >> 8;
-  int lo_bg = color_bg & 0x0F;
-
-  int hi_rim = color_rim >> 8;
-  int lo_rim = color_rim & 0x0F;
-
-  _writeCommand(RAMWR);
-
-  GpioDataRegs.GPASET.bit.GPIO2 = 1;
-  GpioDataRegs.GPACLEAR.bit.GPIO7 = 1;
-
   int row = 0;
   int col = 0;
   int dist = 0;
@@ -138,20 +322,17 @@ void drawCircle(int x, int y, int r_in, int r_out, int color_bg, int color_rim){
       dist = ((row-x)*(row-x)+(col-y)*(col-y));
       if (dist > r_out_square) {
         // outside outer radius
-        spi_send(hi_bg);
-        spi_send(lo_bg);
+        _pushColor(color_bg);
       }
       else if (dist < r_in_square)
       {
         // inside inner radius
-        spi_send(hi_bg);
-        spi_send(lo_bg);
+        _pushColor(color_bg);
       }
       else
       {
        // boundary
-       spi_send(hi_rim);
-       spi_send(lo_rim);
+       _pushColor(color_rim);
        //test_var++;
       }
     }
@@ -159,19 +340,38 @@ void drawCircle(int x, int y, int r_in, int r_out, int color_bg, int color_rim){
   //GpioDataRegs.GPASET.bit.GPIO7 = 1;
 }
 
+// jd: draw character c with its top-left corner at (x, y) in color col on background b,
+//      scaled by size. The whole glyph is one address window and one RAMWR run
+//      (FONT_W*FONT_H*size*size pixels, no spacing around it). Lower case is drawn as
+//      upper case, other characters outside the font as a blank. Returns the glyph width.
+int _writeCharacter(char c, int x, int y, int b, int col, int size){
+    const uint8_t *glyph;
+    int row, column, rep_x, rep_y;
+
+    if((x < 0) || (y < 0) || (x + FONT_W*size > _width) || (y + FONT_H*size > _height)) return 0;
+    if((c >= 'a') && (c <= 'z')) c = c - 'a' + 'A';
+    if((c < FONT_FIRST) || (c > FONT_LAST)) c = ' ';
+    glyph = font5x7[c - FONT_FIRST];
+
+    _startWrite(x, y, x + FONT_W*size - 1, y + FONT_H*size - 1);
+    for(row = 0; row < FONT_H; row++){
+        for(rep_y = 0; rep_y < size; rep_y++){
+            for(column = 0; column < FONT_W; column++){
+                for(rep_x = 0; rep_x < size; rep_x++){
+                    _pushColor(((glyph[column] >> row) & 1) ? col : b);
+                }
+            }
+        }
+    }
+    return FONT_W*size;
+}
+
 // jd: added this function since screen intended to be connected to SPIA only
+//      (register access is in hal.c)
 uint8_t spi_send(const uint8_t data)
 {
-    // put information into SPI buffer
-   while(SpiaRegs.SPISTS.bit.BUFFULL_FLAG == 1)
-   {
-   }
-   SpiaRegs.SPITXBUF = data << 8;
-   while(SpiaRegs.SPISTS.bit.INT_FLAG != 1)
-   {
-   }
-  return(SpiaRegs.SPIRXBUF & 0xFF);
-
+   spi_byte_count++;
+   return(hal_spi_send(data & 0xFF));
 }
 
 //
@@ -181,6 +381,7 @@ void
 delay_loop(long ticks)
 {
     long i;
+    HAL_DELAY_HOOK(ticks);
     for (i = 0; i < ticks; i++)
     {
     }
@@ -15,6 +15,7 @@ https://github.com/matevzmars/ST7735R
 #define SPI_SCREEN_H
 
 #include "Peripheral_Headers/F2802x_Device.h"
+#include "display.h"
 
 // constants needed to control screen
 // jd: removed unneeded constants
@@ -26,11 +27,18 @@ https://github.com/matevzmars/ST7735R
 #define CASET       0x2a
 #define RASET       0x2b
 #define RAMWR       0x2c
-#define _width      130
-#define _height     130
+#define INVON       0x21    // jd: display inversion on (ST7789 panels need it)
+#define VSCRDEF     0x33    // jd: vertical scroll area (top fixed, scroll, bottom fixed rows)
+#define VSCSAD      0x37    // jd: vertical scroll start address
+#define _width      (display->width)    // jd: geometry of the selected display driver
+#define _height     (display->height)
+#define FONT_W      5       // jd: glyph size of _writeCharacter (size 1)
+#define FONT_H      7
 
 #define STD_DEL     1000000
 
+extern Uint32 spi_byte_count; // jd: bytes sent to the screen so far
+
 // jd: removed unneeded functions
 void delay_loop(long ticks);
 void screen_begin(void);
@@ -41,7 +49,12 @@ void drawCircle(int x, int y, int r_in, int r_out, int color_bg, int color_rim);
 void _writeCommand(int c);
 void _writeData(int c);
 void _setAddressWindow(int x0, int y0, int x1, int y1);
-int _writeCharacter(char c, int x, int y, int b, int col, int size);
+void _startWrite(int x0, int y0, int x1, int y1);  // jd: added this function
+void _pushColor(int color);                         // jd: added this function
+void _fillColor(int color, Uint32 count);           // jd: added this function
+int _writeCharacter(char c, int x, int y, int b, int col, int size); // jd: implemented this function
+void setScrollArea(int top, int rows, int bottom);  // jd: added this function
+void scrollTo(int line);                            // jd: added this function
 uint8_t spi_send(const uint8_t data); // jd: added this function
 
 #endif
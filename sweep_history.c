@@ -0,0 +1,210 @@
+// sweep_history.c
+// Author: Joseph Dobrzanski
+// Keeps returns from earlier sweeps on screen in dimmer colors ("ghosts") until
+// they are HISTORY_SWEEPS sweeps old.
+// A ghost is only created when a bin's return changes or drops out, and it is only
+// redrawn when it steps to the next shade, so SPI traffic follows the amount of
+// change in the scene rather than the history depth.
+// Pixels are written through render_owner_change(), so a ghost never covers a
+// brighter point of a neighbouring bin. Call with lock_Sem held.
+
+#include "sweep_history.h"
+#include "render.h"
+#include "layers.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+// ghost pixels are stored relative to the disc center, 8 bits each
+#define GHOST_X(gh)     ((int16)(gh)->x + DISC_X - 128)
+#define GHOST_Y(gh)     ((int16)(gh)->y + DISC_Y - 128)
+#define GHOST_FITS(x, y) (((x) - DISC_X >= -128) && ((x) - DISC_X < 128) && ((y) - DISC_Y >= -128) && ((y) - DISC_Y < 128))
+
+// [SHADE_LIVE] is a freshly swept return, the phosphor colors of older live returns follow
+// (blues, so they stay apart from the grey ghosts on the white disc),
+// [SHADE_NONE - 1] is the oldest ghost (fades towards the white disc)
+const Uint16 history_palette[SHADE_NONE] = {
+    TARGET_COLOR,
+#if PHOSPHOR_STEPS > 1
+    0x0013,     // navy
+#endif
+#if PHOSPHOR_STEPS > 2
+    0x3A7F,     // light blue
+#endif
+    0x4208, 0x8410, 0xC618
+};
+
+static struct ghost ghosts[HISTORY_GHOSTS];
+static Uint16 ghost_head[(NUM_POINTS + 1) / 2]; // first ghost of each bin, two bins per word
+static Uint16 free_head = GHOST_NONE;
+
+static Uint16 head_get(int16 bin)
+{
+    Uint16 pair = ghost_head[bin >> 1];
+    return (bin & 1) ? (pair >> 8) : (pair & 0xFF);
+}
+
+static void head_set(int16 bin, Uint16 g)
+{
+    Uint16 pair = ghost_head[bin >> 1];
+    if (bin & 1) {
+        pair = (pair & 0x00FF) | (g << 8);
+    } else {
+        pair = (pair & 0xFF00) | g;
+    }
+    ghost_head[bin >> 1] = pair;
+}
+
+// palette index of a ghost that is "age" sweeps old (1 <= age < HISTORY_SWEEPS)
+static Uint16 shade_of(Uint16 age)
+{
+    return SHADE_GHOST + ((age - 1) * HISTORY_SHADES) / HISTORY_SWEEPS;
+}
+
+void history_init(void)
+{
+    int index;
+    for (index = 0; index < (NUM_POINTS + 1) / 2; index++) {
+        ghost_head[index] = (GHOST_NONE << 8) | GHOST_NONE;
+    }
+    for (index = 0; index < HISTORY_GHOSTS; index++) {
+        ghosts[index].next = (index + 1 < HISTORY_GHOSTS) ? index + 1 : GHOST_NONE;
+    }
+    free_head = 0;
+}
+
+// the bin's return at (x, y) was replaced or not refreshed this sweep: start fading it out.
+// Clear points_angle[bin] first if the bin has no live point anymore.
+void history_retire(int16 bin, int16 x, int16 y)
+{
+    Uint16 g = free_head;
+
+    if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) return; // was never drawn
+    if ((HISTORY_SWEEPS < 2) || (g == GHOST_NONE) || !GHOST_FITS(x, y)) {
+        // no history kept, no room left, or too far out to store: clear the point like before
+        render_owner_change(x, y, bin, SHADE_LIVE, SHADE_NONE);
+        return;
+    }
+    free_head = ghosts[g].next;
+
+    ghosts[g].x = x - DISC_X + 128;
+    ghosts[g].y = y - DISC_Y + 128;
+    ghosts[g].birth = sweep_count;
+    ghosts[g].shade = shade_of(1);
+    ghosts[g].next = head_get(bin);
+    head_set(bin, g);
+
+    render_owner_change(x, y, bin, SHADE_LIVE, ghosts[g].shade);
+}
+
+// a live point is about to be drawn at (x, y): drop any ghost of this bin on that pixel.
+// Returns the shade that was dropped (SHADE_NONE if there was none).
+Uint16 history_claim(int16 bin, int16 x, int16 y)
+{
+    Uint16 prev = GHOST_NONE;
+    Uint16 g = head_get(bin);
+    Uint16 dropped = SHADE_NONE;
+
+    while (g != GHOST_NONE) {
+        Uint16 next = ghosts[g].next;
+        HAL_COST(COST_CYCLES, 14);
+        if ((GHOST_X(&ghosts[g]) == x) && (GHOST_Y(&ghosts[g]) == y)) {
+            dropped = ghosts[g].shade;
+            if (prev == GHOST_NONE) {
+                head_set(bin, next);
+            } else {
+                ghosts[prev].next = next;
+            }
+            ghosts[g].next = free_head;
+            free_head = g;
+        } else {
+            prev = g;
+        }
+        g = next;
+    }
+    return dropped;
+}
+
+// the sweep has passed this bin: step its ghosts to their new shade, erase expired ones
+void history_age_bin(int16 bin)
+{
+    Uint16 prev = GHOST_NONE;
+    Uint16 g = head_get(bin);
+
+    while (g != GHOST_NONE) {
+        struct ghost *gh = &ghosts[g];
+        Uint16 next = gh->next;
+        Uint16 age = ((sweep_count - gh->birth) & 0x1F) + 1;
+
+        HAL_COST(COST_CYCLES, 20);
+
+        if (age >= HISTORY_SWEEPS) {
+            if (prev == GHOST_NONE) {
+                head_set(bin, next);
+            } else {
+                ghosts[prev].next = next;
+            }
+            gh->next = free_head;
+            free_head = g;
+            render_owner_change(GHOST_X(gh), GHOST_Y(gh), bin, gh->shade, SHADE_NONE);
+        } else {
+            Uint16 shade = shade_of(age);
+            Uint16 old_shade = gh->shade;
+            gh->shade = shade;
+            render_owner_change(GHOST_X(gh), GHOST_Y(gh), bin, old_shade, shade);
+            prev = g;
+        }
+        g = next;
+    }
+}
+
+// erase all ghosts of this bin (they were drawn with another zoom level)
+void history_drop_bin(int16 bin)
+{
+    Uint16 g = head_get(bin);
+    Uint16 next;
+
+    head_set(bin, GHOST_NONE);
+    while (g != GHOST_NONE) {
+        next = ghosts[g].next;
+        HAL_COST(COST_CYCLES, 14);
+        ghosts[g].next = free_head;
+        free_head = g;
+        render_owner_change(GHOST_X(&ghosts[g]), GHOST_Y(&ghosts[g]), bin, ghosts[g].shade, SHADE_NONE);
+        g = next;
+    }
+}
+
+// shade of this bin's ghost on (x, y), SHADE_NONE if it has none there
+Uint16 history_shade_at(int16 bin, int16 x, int16 y)
+{
+    Uint16 g = head_get(bin);
+
+    HAL_COST(COST_CYCLES, 10);
+    while (g != GHOST_NONE) {
+        HAL_COST(COST_CYCLES, 12);
+        if ((GHOST_X(&ghosts[g]) == x) && (GHOST_Y(&ghosts[g]) == y)) {
+            return ghosts[g].shade;
+        }
+        g = ghosts[g].next;
+    }
+    return SHADE_NONE;
+}
+
+// true if a ghost of this bin is within d pixels (Chebyshev) of (x, y)
+int history_near(int16 bin, int16 x, int16 y, int16 d)
+{
+    Uint16 g = head_get(bin);
+    int16 dx, dy;
+
+    HAL_COST(COST_CYCLES, 10);
+    while (g != GHOST_NONE) {
+        HAL_COST(COST_CYCLES, 16);
+        dx = GHOST_X(&ghosts[g]) - x;
+        dy = GHOST_Y(&ghosts[g]) - y;
+        if ((dx >= -d) && (dx <= d) && (dy >= -d) && (dy <= d)) {
+            return 1;
+        }
+        g = ghosts[g].next;
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+// sweep_history.h
+// Author: Joseph Dobrzanski
+// N-sweep history of returns for the aged-persistence ("ghost") display.
+// Only bins whose return changed from one sweep to the next are recorded,
+// so the store holds the deltas between sweeps rather than N full sweeps.
+
+#ifndef SWEEP_HISTORY_H
+#define SWEEP_HISTORY_H
+
+#include "main_file.h"
+#include "phosphor.h"
+
+#define HISTORY_SWEEPS  6       // a retired return is erased after this many sweeps (max 31)
+#define HISTORY_SHADES  3       // number of dimmer palette colors a ghost steps through (max 7 - PHOSPHOR_STEPS)
+#define HISTORY_GHOSTS  128     // ghosts that can be on screen at once (max 255)
+#define GHOST_NONE      0xFF    // end of a bin's ghost chain
+
+// palette index of what owns a pixel: lower is brighter and wins a shared pixel
+#define SHADE_LIVE      0                       // live return, just swept (dims up to SHADE_GHOST - 1, phosphor.c)
+#define SHADE_GHOST     PHOSPHOR_STEPS          // brightest ghost
+#define SHADE_NONE      (SHADE_GHOST + HISTORY_SHADES)  // nothing, pixel shows the background
+
+// one retired return still shown on screen (2 words)
+struct ghost {
+    Uint16 x:8;         // pixel relative to the disc center (+ 128)
+    Uint16 y:8;
+    Uint16 next:8;      // next ghost in the same bin, GHOST_NONE ends the chain
+    Uint16 birth:5;     // sweep_count when the return was retired (mod 32)
+    Uint16 shade:3;     // palette index currently drawn on the screen
+};
+
+extern const Uint16 history_palette[SHADE_NONE];
+
+void history_init(void);
+void history_retire(int16 bin, int16 x, int16 y);
+Uint16 history_claim(int16 bin, int16 x, int16 y);
+void history_age_bin(int16 bin);
+void history_drop_bin(int16 bin);
+Uint16 history_shade_at(int16 bin, int16 x, int16 y);
+int history_near(int16 bin, int16 x, int16 y, int16 d);
+
+#endif
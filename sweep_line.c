@@ -0,0 +1,172 @@
+// sweep_line.c
+// Author: Joseph Dobrzanski
+// Rotating sweep line driven by the encoder bin, drawn with an integer Bresenham
+// rasterizer. The line is the top background layer (layer_color() asks
+// sweep_line_covers()), points are drawn over it, and pixels it leaves get the
+// owner or layer color back through the same rules as render.c.
+// Call sweep_line_tick() once per encoder tick with lock_Sem held. One pixel costs
+// at most 13 bytes, so a tick never sends more than "budget" + 12 bytes for the line.
+
+#include "sweep_line.h"
+#include "bin_trig.h"
+#include "render.h"
+#include "spi_screen.h"
+#include "hal.h"
+
+// pixels are stored relative to the disc center, 8 bits each
+#define PACK(x, y)      (((Uint16)((x) - DISC_X + 128) << 8) | (Uint16)((y) - DISC_Y + 128))
+#define UNPACK_X(px)    ((int16)((px) >> 8) + DISC_X - 128)
+#define UNPACK_Y(px)    ((int16)((px) & 0xFF) + DISC_Y - 128)
+
+// phases of moving the line
+#define LINE_IDLE       0
+#define LINE_RESTORE    1   // giving the old pixels their background back
+#define LINE_DRAW       2   // drawing the new pixels
+
+Uint16 sweep_line_max_bytes = 0;
+
+static Uint16 line_a[SWEEP_MAX_PX];
+static Uint16 line_b[SWEEP_MAX_PX];
+static Uint16 *line = line_a;   // line the screen is moving to (what layer_color() reports)
+static Uint16 *old = line_b;    // line being replaced
+static int16 line_len = 0;
+static int16 old_len = 0;
+static int16 line_bin = -1;
+static int16 old_bin = 0;
+static int16 phase = LINE_IDLE;
+static int16 step = 0;
+
+// Bresenham line from the disc center to SWEEP_LEN pixels out at the bin's angle
+static int16 rasterize(int16 bin, Uint16 *px)
+{
+    int16 len = (SWEEP_LEN < DISPLAY_MAX_R) ? SWEEP_LEN : DISPLAY_MAX_R;
+    int16 ex = (int16)(((int32)len * bin_cos[bin] + (1L << (TRIG_SHIFT - 1))) >> TRIG_SHIFT);
+    int16 ey = (int16)(((int32)len * bin_sin[bin] + (1L << (TRIG_SHIFT - 1))) >> TRIG_SHIFT);
+    int16 dx = (ex < 0) ? -ex : ex;
+    int16 dy = (ey < 0) ? -ey : ey;
+    int16 sx = (ex < 0) ? -1 : 1;
+    int16 sy = (ey < 0) ? -1 : 1;
+    int16 err = dx - dy;
+    int16 e2;
+    int16 x = 0;
+    int16 y = 0;
+    int16 n = 0;
+
+    HAL_COST(COST_MUL32, 2);
+    HAL_COST(COST_CYCLES, 30);
+    while (1) {
+        HAL_COST(COST_CYCLES, 14);
+        px[n++] = PACK(DISC_X + x, DISC_Y + y);
+        if ((x == ex) && (y == ey)) break;
+        e2 = 2*err;
+        if (e2 > -dy) {
+            err -= dy;
+            x += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+    return n;
+}
+
+// both lines start at the center, so a shared pixel sits at (nearly) the same index
+static int near_index(const Uint16 *px, int16 len, Uint16 pixel, int16 index)
+{
+    int16 i;
+
+    HAL_COST(COST_CYCLES, 6);
+    for (i = index - 2; i <= index + 2; i++) {
+        HAL_COST(COST_CYCLES, 8);
+        if ((i >= 0) && (i < len) && (px[i] == pixel)) return 1;
+    }
+    return 0;
+}
+
+// true if (x, y) is part of the sweep line. Every step of rasterize() moves one pixel
+// along the major axis, so pixel i of the line is i pixels out (Chebyshev distance)
+// and (x, y) can only be line[i] for that i.
+int sweep_line_covers(int16 x, int16 y)
+{
+    int16 dx = (x < DISC_X) ? DISC_X - x : x - DISC_X;
+    int16 dy = (y < DISC_Y) ? DISC_Y - y : y - DISC_Y;
+    int16 i = (dx > dy) ? dx : dy;
+
+    HAL_COST(COST_CYCLES, 16);
+    return (i < line_len) && (line[i] == PACK(x, y));
+}
+
+// true if (x, y) is still waiting for the move that is under way: an old pixel not yet given its
+// background back, or a new pixel not yet drawn
+int sweep_line_pending(int16 x, int16 y)
+{
+    Uint16 pixel;
+    int16 i;
+
+    if (phase == LINE_IDLE) return 0;
+    if ((x < DISC_X - DISPLAY_MAX_R) || (x > DISC_X + DISPLAY_MAX_R) || (y < DISC_Y - DISPLAY_MAX_R) || (y > DISC_Y + DISPLAY_MAX_R)) return 0;
+    pixel = PACK(x, y);
+    if (phase == LINE_RESTORE) {
+        for (i = step; i < old_len; i++) {
+            if (old[i] == pixel) return 1;
+        }
+    }
+    for (i = (phase == LINE_DRAW) ? step : 0; i < line_len; i++) {
+        if (line[i] == pixel) return 1;
+    }
+    return 0;
+}
+
+void sweep_line_tick(int16 bin, Uint16 budget)
+{
+    Uint32 start = spi_byte_count;
+    Uint16 sent, pixel, shade;
+    Uint16 *swap;
+
+    if ((phase == LINE_IDLE) && (bin != line_bin) && (bin < NUM_BINS)) {
+        // start moving to the current bin (bins passed while the last move ran are skipped)
+        swap = old;
+        old = line;
+        line = swap;
+        old_len = line_len;
+        old_bin = (line_bin < 0) ? bin : line_bin;
+        line_len = rasterize(bin, line);
+        line_bin = bin;
+        phase = LINE_RESTORE;
+        step = 0;
+    }
+
+    while ((phase != LINE_IDLE) && ((spi_byte_count - start) < budget)) {
+        HAL_COST(COST_CYCLES, 12);
+        if (phase == LINE_RESTORE) {
+            if (step < old_len) {
+                pixel = old[step];
+                if (!near_index(line, line_len, pixel, step)) {
+                    shade = pixel_shade(UNPACK_X(pixel), UNPACK_Y(pixel), old_bin);
+                    drawPixel(UNPACK_X(pixel), UNPACK_Y(pixel), (shade == SHADE_NONE) ? layer_color(UNPACK_X(pixel), UNPACK_Y(pixel)) : history_palette[shade]);
+                }
+                step++;
+            } else {
+                phase = LINE_DRAW;
+                step = 0;
+            }
+        } else {
+            if (step < line_len) {
+                pixel = line[step];
+                // points stay on top of the line
+                if (!near_index(old, old_len, pixel, step) && (pixel_shade(UNPACK_X(pixel), UNPACK_Y(pixel), line_bin) == SHADE_NONE)) {
+                    drawPixel(UNPACK_X(pixel), UNPACK_Y(pixel), SWEEP_COLOR);
+                }
+                step++;
+            } else {
+                phase = LINE_IDLE;
+            }
+        }
+    }
+
+    sent = spi_byte_count - start;
+    if (sent > sweep_line_max_bytes) {
+        sweep_line_max_bytes = sent;
+    }
+}
@@ -0,0 +1,23 @@
+// sweep_line.h
+// Author: Joseph Dobrzanski
+// Rotating sweep line that follows the encoder bin. Moving the line only sends
+// the pixels that differ between its old and new position, spread over as many
+// encoder ticks as needed to stay inside the share of the tick budget it is given.
+
+#ifndef SWEEP_LINE_H
+#define SWEEP_LINE_H
+
+#include "main_file.h"
+#include "layers.h"
+
+#define SWEEP_COLOR     0x07E0                      // bright green
+#define SWEEP_LEN       (DISC_R - RIM_WIDTH - 1)    // from the center to just inside the rim
+#define SWEEP_MAX_PX    (DISPLAY_MAX_R + 1)         // room for the Bresenham pixels of the longest line
+
+extern Uint16 sweep_line_max_bytes; // worst-case bytes measured for one tick (see "Expressions")
+
+void sweep_line_tick(int16 bin, Uint16 budget);
+int sweep_line_covers(int16 x, int16 y);
+int sweep_line_pending(int16 x, int16 y);
+
+#endif
@@ -0,0 +1,138 @@
+// trace.c
+// Author: Joseph Dobrzanski
+// RAM ring of input events (format in trace.h). trace_record() is called from
+// the Hwis and the idle thread, so it runs with interrupts disabled. The dump
+// is sent from the idle thread, as many bytes per pass as the SCI TX FIFO
+// takes, and recording pauses until it is done.
+
+#include "trace.h"
+#include "hal.h"
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+// the flags are in every build: the other SCI TX reports wait while "trace_dump" is set
+int16 trace_enable = 1;
+int16 trace_dump = 0;
+
+#if DIAG_BUILD
+
+static Uint16 ring[TRACE_BYTES / 2];   // two bytes per word
+static Uint16 head = 0;     // next byte written
+static Uint16 tail = 0;     // first byte of the oldest record
+static Uint16 used = 0;     // bytes in the ring
+static Uint32 last_time = 0;
+
+static Uint16 dump_pos = 0; // bytes of header and ring sent so far
+static Uint16 dump_len = 0; // record bytes being sent
+static Uint32 dump_freq = 0;
+
+static Uint16 ring_get(Uint16 pos)
+{
+    Uint16 pair = ring[pos >> 1];
+    return (pos & 1) ? (pair & 0xFF) : (pair >> 8);
+}
+
+static void ring_put(Uint16 pos, Uint16 b)
+{
+    Uint16 pair = ring[pos >> 1];
+    if (pos & 1) {
+        pair = (pair & 0xFF00) | (b & 0xFF);
+    } else {
+        pair = (pair & 0x00FF) | (b << 8);
+    }
+    ring[pos >> 1] = pair;
+}
+
+static void put_byte(Uint16 b)
+{
+    ring_put(head, b);
+    head = (head + 1) % TRACE_BYTES;
+    used++;
+}
+
+// drop the oldest record
+static void drop_oldest(void)
+{
+    Uint16 b = ring_get(tail);
+    Uint16 len = 1;
+
+    if (b & 0x20) {
+        do {
+            len++;
+        } while (ring_get((tail + len - 1) % TRACE_BYTES) & 0x80);
+    }
+    if ((b >> 6) == TRACE_SAMPLE) len++;
+    tail = (tail + len) % TRACE_BYTES;
+    used -= len;
+}
+
+void trace_record(Uint16 type, Uint16 data)
+{
+    UInt key;
+    Uint32 now, delta;
+
+    if (!trace_enable || trace_dump) return;
+    key = Hwi_disable();
+    now = Timestamp_get32();
+    delta = (now - last_time) >> TRACE_TIME_SHIFT;
+    last_time = now;
+
+    while (used > TRACE_BYTES - TRACE_MAX_RECORD) {
+        drop_oldest();
+    }
+    put_byte((type << 6) | ((delta > 0x1F) ? 0x20 : 0) | (delta & 0x1F));
+    delta >>= 5;
+    while (delta != 0) {
+        put_byte(((delta > 0x7F) ? 0x80 : 0) | (delta & 0x7F));
+        delta >>= 7;
+    }
+    if (type == TRACE_SAMPLE) put_byte(data);
+    Hwi_restore(key);
+}
+
+// byte "pos" of the dump
+static Uint16 dump_byte(Uint16 pos)
+{
+    switch (pos) {
+    case 0: return 'L';
+    case 1: return 'T';
+    case 2: return 'R';
+    case 3: return '1';
+    case 4: return TRACE_TIME_SHIFT;
+    case 5: return 0;
+    case 6: return (Uint16)(dump_freq >> 24) & 0xFF;
+    case 7: return (Uint16)(dump_freq >> 16) & 0xFF;
+    case 8: return (Uint16)(dump_freq >> 8) & 0xFF;
+    case 9: return (Uint16)dump_freq & 0xFF;
+    case 10: return dump_len >> 8;
+    case 11: return dump_len & 0xFF;
+    }
+    return ring_get((tail + pos - TRACE_HEADER) % TRACE_BYTES);
+}
+
+// call from the idle thread: sends the next dump bytes while "trace_dump" is set
+void trace_dump_tick(void)
+{
+    Types_FreqHz freq;
+
+    if (!trace_dump) return;
+    if (dump_pos == 0) {
+        Timestamp_getFreq(&freq);
+        dump_freq = freq.lo;
+        dump_len = used;
+    }
+    while ((dump_pos < TRACE_HEADER + dump_len) && HAL_SCI_TX_READY()) {
+        HAL_SCI_TX_BYTE(dump_byte(dump_pos));
+        dump_pos++;
+    }
+    if (dump_pos == TRACE_HEADER + dump_len) {
+        // start a new recording
+        head = tail = used = 0;
+        dump_pos = 0;
+        last_time = Timestamp_get32();
+        trace_dump = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,44 @@
+// trace.h
+// Author: Joseph Dobrzanski
+// Input timeline recorder. Encoder ticks, IR index pulses and LIDAR samples go
+// into a RAM ring as they come in; setting "trace_dump" sends the ring over
+// SCI TX (GPIO29), so a run seen in the field can be replayed on the host build
+// (host/sim -R). The ring is built only with DIAG_BUILD (main_file.h); without
+// it the flags below are still there but nothing is recorded or sent.
+//
+// Dump: "LTR1", TRACE_TIME_SHIFT, 0, Timestamp frequency (4 bytes), record
+// bytes (2 bytes), then the records, oldest first. Multi-byte fields are big-endian.
+// Record: type in bits 7..6, bit 5 set if more delta bytes follow, bits 4..0
+// the low bits of the delta time; each further delta byte has 7 more bits
+// (bit 7 = more follow). TRACE_SAMPLE records end with the distance byte.
+// Delta times are in units of 2^TRACE_TIME_SHIFT Timestamp counts since the
+// previous record (the first record's delta is from an event no longer in the ring).
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "main_file.h"
+
+#define TRACE_ENCODER   0   // encoder_Fxn
+#define TRACE_IR        1   // IR_Fxn
+#define TRACE_SAMPLE    2   // distance byte read from SCI
+
+#ifndef TRACE_BYTES
+#define TRACE_BYTES     1024    // ring size (two bytes per word, about one sweep at 60 RPM): 512 words
+#endif
+#define TRACE_TIME_SHIFT 6      // delta unit: 64 Timestamp counts (~1 us at 60 MHz)
+#define TRACE_MAX_RECORD 6      // type/delta byte, 4 more delta bytes, distance
+#define TRACE_HEADER    12      // dump bytes before the records
+
+extern int16 trace_enable;  // can be changed through the "Expressions" watch list
+extern int16 trace_dump;    // set to 1 through the "Expressions" watch list to send the ring, back to 0 when sent
+
+#if DIAG_BUILD
+void trace_record(Uint16 type, Uint16 data);
+void trace_dump_tick(void);
+#else
+#define trace_record(type, data)    ((void)0)
+#define trace_dump_tick()           ((void)(trace_dump = 0))  // no ring to send
+#endif
+
+#endif
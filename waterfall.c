@@ -0,0 +1,58 @@
+// waterfall.c
+// Author: Joseph Dobrzanski
+// Waterfall history view. The whole panel is one scroll area; a new sweep is
+// written into the display RAM row just above the current top row and the
+// scroll start is moved onto it, so adding a sweep costs one row window
+// (_width pixels) plus a VSCSAD command instead of repainting the history.
+// Call with lock_Sem held.
+
+#include "waterfall.h"
+#include "bscan.h"
+#include "spi_screen.h"
+
+// nearest range first, fading towards the white background
+static const Uint16 waterfall_colors[WATERFALL_LEVELS] = {TARGET_COLOR, 0x4208, 0x8410, 0xC618};
+
+static int16 top_row = 0; // display RAM row shown at the top of the panel
+
+// clear the panel and make it one scroll area
+void waterfall_begin(void)
+{
+    fillScreen(BACKGROUND_COLOR);
+    setScrollArea(0, _height, display->gram_rows - _height);
+    top_row = 0;
+    scrollTo(top_row);
+}
+
+// put the scroll back at the start, so the other views can draw at screen coordinates
+void waterfall_end(void)
+{
+    top_row = 0;
+    scrollTo(top_row);
+}
+
+// the sweep has left "bin": after the last bin, add the sweep as a new row at the top
+void waterfall_bin_left(int16 bin)
+{
+    int16 column, index, r, nearest;
+    int color;
+
+    if (bin != NUM_BINS - 1) return;
+
+    top_row = (top_row + _height - 1) % _height;
+    _startWrite(0, top_row, _width - 1, top_row);
+    for (column = 0; column < _width; column++) {
+        nearest = -1;
+        for (index = BSCAN_FIRST_BIN(column); index < BSCAN_FIRST_BIN(column + 1); index++) {
+            r = bscan_range(index);
+            if ((r >= 0) && ((nearest < 0) || (r < nearest))) nearest = r;
+        }
+        if ((nearest < 0) || (nearest > BSCAN_MAX_RANGE)) {
+            color = BACKGROUND_COLOR;
+        } else {
+            color = waterfall_colors[((int32)nearest * WATERFALL_LEVELS) / (BSCAN_MAX_RANGE + 1)];
+        }
+        _pushColor(color);
+    }
+    scrollTo(top_row);
+}
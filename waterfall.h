@@ -0,0 +1,19 @@
+// waterfall.h
+// Author: Joseph Dobrzanski
+// Waterfall history view: every completed sweep adds one row (bearing across,
+// nearest range of each column as a color) at the top of the panel and the
+// older rows move down through the screen's hardware vertical scroll. Ranges
+// are the B-scan's (bscan_range()), so a row is drawn with the zoom of its sweep.
+
+#ifndef WATERFALL_H
+#define WATERFALL_H
+
+#include "main_file.h"
+
+#define WATERFALL_LEVELS 4      // range colors, nearest first
+
+void waterfall_begin(void);
+void waterfall_end(void);
+void waterfall_bin_left(int16 bin);
+
+#endif